@@ -3,14 +3,20 @@
 #include <GL/glut.h>
 #include <iostream>
 #include <vector>
+#include "Transform.h"
 
 using namespace std;
 
-// Define the initial object (a triangle)
-vector<pair<float, float>> object = {
-    {100.0f, 100.0f}, {200.0f, 100.0f}, {150.0f, 200.0f}
+// Define the initial object (a triangle); it is never modified
+VertexArray2 object = {
+    {100.0f, 200.0f, 150.0f},
+    {100.0f, 100.0f, 200.0f}
 };
 
+// Object after the current transformations, rebuilt from the original every frame
+VertexArray2 transformed;
+TransformStack2D objectTransform;
+
 // Transformation matrices
 float tx = 0.0f, ty = 0.0f;  // Translation parameters
 float sx = 1.0f, sy = 1.0f;  // Scaling factors
@@ -19,58 +25,43 @@ float shx = 0.0f, shy = 0.0f; // Shearing factors
 
 // Function to apply translation
 void translateObject() {
-    for (auto &point : object) {
-        point.first += tx;
-        point.second += ty;
-    }
+    objectTransform.translate(tx, ty);
 }
 
 // Function to apply scaling
 void scaleObject() {
-    for (auto &point : object) {
-        point.first *= sx;
-        point.second *= sy;
-    }
+    objectTransform.scale(sx, sy);
 }
 
 // Function to apply rotation
 void rotateObject() {
-    float rad = angle * 3.14159265358979f / 180.0f; // Convert angle to radians
-    for (auto &point : object) {
-        float xNew = point.first * cos(rad) - point.second * sin(rad);
-        float yNew = point.first * sin(rad) + point.second * cos(rad);
-        point.first = xNew;
-        point.second = yNew;
-    }
+    objectTransform.rotate(degreesToRadians(angle));
 }
 
 // Function to apply shearing
 void shearObject() {
-    for (auto &point : object) {
-        point.first += shx * point.second;
-        point.second += shy * point.first;
-    }
+    objectTransform.shear(shx, shy);
 }
 
 // Function to draw the object
 void drawObject() {
     glBegin(GL_POLYGON); // Drawing the object (a triangle)
-    for (auto &point : object) {
-        glVertex2f(point.first, point.second);
+    for (size_t i = 0; i < transformed.size(); i++) {
+        glVertex2f(transformed.x[i], transformed.y[i]);
     }
     glEnd();
 }
 
-// Function to apply all transformations
+// Function to apply all transformations: translation first, then scaling, rotation and
+// shearing. The stack applies the last operation issued first, so they are issued in reverse
+// and composed into one matrix before touching the vertices.
 void applyTransformations() {
-    // Apply translation
-    translateObject();
-    // Apply scaling
-    scaleObject();
-    // Apply rotation
-    rotateObject();
-    // Apply shearing
+    objectTransform.loadIdentity();
     shearObject();
+    rotateObject();
+    scaleObject();
+    translateObject();
+    transformVertices(objectTransform.matrix(), object, transformed);
 }
 
 // Display function
@@ -3,6 +3,7 @@
 #include <GL/glut.h>
 #include <iostream>
 #include <cmath>
+#include "Transform.h"
 
 using namespace std;
 
@@ -11,18 +12,17 @@ float tx = 0.0f, ty = 0.0f, tz = 0.0f;  // Translation
 float sx = 1.0f, sy = 1.0f, sz = 1.0f;  // Scaling
 float angleX = 0.0f, angleY = 0.0f, angleZ = 0.0f;  // Rotation angles
 
-// Cube vertices
-GLfloat cubeVertices[8][3] = {
-    {-1.0f, -1.0f, -1.0f},
-    {1.0f, -1.0f, -1.0f},
-    {1.0f, 1.0f, -1.0f},
-    {-1.0f, 1.0f, -1.0f},
-    {-1.0f, -1.0f, 1.0f},
-    {1.0f, -1.0f, 1.0f},
-    {1.0f, 1.0f, 1.0f},
-    {-1.0f, 1.0f, 1.0f}
+// Cube vertices (x, y and z of vertices 0-7); never modified
+VertexArray3 cubeVertices = {
+    {-1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f},
+    {-1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f},
+    {-1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f}
 };
 
+// Cube after this frame's transformations
+VertexArray3 transformedVertices;
+TransformStack3D cubeTransform;
+
 // Cube edges (connecting vertices)
 GLint cubeEdges[12][2] = {
     {0, 1}, {1, 2}, {2, 3}, {3, 0}, 
@@ -32,59 +32,30 @@ GLint cubeEdges[12][2] = {
 
 // Function to apply translation to the cube
 void translateCube() {
-    for (int i = 0; i < 8; i++) {
-        cubeVertices[i][0] += tx;
-        cubeVertices[i][1] += ty;
-        cubeVertices[i][2] += tz;
-    }
+    cubeTransform.translate(tx, ty, tz);
 }
 
 // Function to apply scaling to the cube
 void scaleCube() {
-    for (int i = 0; i < 8; i++) {
-        cubeVertices[i][0] *= sx;
-        cubeVertices[i][1] *= sy;
-        cubeVertices[i][2] *= sz;
-    }
+    cubeTransform.scale(sx, sy, sz);
 }
 
-// Function to apply rotation to the cube
+// Function to apply rotation to the cube: about X, then Y, then Z (angles in degrees)
 void rotateCube() {
-    // Rotation along X-axis
-    float tempY, tempZ;
-    for (int i = 0; i < 8; i++) {
-        tempY = cubeVertices[i][1];
-        tempZ = cubeVertices[i][2];
-        cubeVertices[i][1] = tempY * cos(angleX) - tempZ * sin(angleX);
-        cubeVertices[i][2] = tempY * sin(angleX) + tempZ * cos(angleX);
-    }
-
-    // Rotation along Y-axis
-    float tempX, tempZ;
-    for (int i = 0; i < 8; i++) {
-        tempX = cubeVertices[i][0];
-        tempZ = cubeVertices[i][2];
-        cubeVertices[i][0] = tempX * cos(angleY) + tempZ * sin(angleY);
-        cubeVertices[i][2] = -tempX * sin(angleY) + tempZ * cos(angleY);
-    }
-
-    // Rotation along Z-axis
-    for (int i = 0; i < 8; i++) {
-        tempX = cubeVertices[i][0];
-        tempY = cubeVertices[i][1];
-        cubeVertices[i][0] = tempX * cos(angleZ) - tempY * sin(angleZ);
-        cubeVertices[i][1] = tempX * sin(angleZ) + tempY * cos(angleZ);
-    }
+    cubeTransform.rotateZ(degreesToRadians(angleZ));
+    cubeTransform.rotateY(degreesToRadians(angleY));
+    cubeTransform.rotateX(degreesToRadians(angleX));
 }
 
 // Function to draw the cube
 void drawCube() {
+    const VertexArray3& v = transformedVertices;
     glBegin(GL_LINES);
     for (int i = 0; i < 12; i++) {
         int startVertex = cubeEdges[i][0];
         int endVertex = cubeEdges[i][1];
-        glVertex3f(cubeVertices[startVertex][0], cubeVertices[startVertex][1], cubeVertices[startVertex][2]);
-        glVertex3f(cubeVertices[endVertex][0], cubeVertices[endVertex][1], cubeVertices[endVertex][2]);
+        glVertex3f(v.x[startVertex], v.y[startVertex], v.z[startVertex]);
+        glVertex3f(v.x[endVertex], v.y[endVertex], v.z[endVertex]);
     }
     glEnd();
 }
@@ -108,10 +79,13 @@ void display() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glLoadIdentity();
 
-    // Apply transformations
-    translateCube();
-    scaleCube();
+    // Compose translation, scaling and rotation (applied to the vertices in that order) into
+    // one matrix, then transform the original cube with it
+    cubeTransform.loadIdentity();
     rotateCube();
+    scaleCube();
+    translateCube();
+    transformVertices(cubeTransform.matrix(), cubeVertices, transformedVertices);
 
     // Set color for the cube
     glColor3f(1.0f, 0.0f, 0.0f); // Red color
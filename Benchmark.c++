@@ -0,0 +1,382 @@
+/* Benchmark suite for the headless algorithm library.
+Every algorithm runs on a seeded random workload at increasing sizes. One operation is one
+call over the whole workload (all lines, all polygons, ...). For each size the table reports
+items per second at the median, p50/p99 latency of one operation, and heap allocations per
+operation, counted by replacing the global operator new.
+
+Usage: Benchmark [--seed N] [--max-size N] [--filter NAME] [--csv FILE] [--quick]
+Build with GRAPHICS_INSTRUMENTATION to also print the hot-path probe report. */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "CurveTessellator.h"
+#include "Framebuffer.h"
+#include "Instrumentation.h"
+#include "LineClipBatch.h"
+#include "PolygonClip.h"
+#include "RasterPrimitives.h"
+#include "ScanlineFill.h"
+#include "SoftwareRasterizer.h"
+#include "Transform.h"
+using namespace std;
+
+// ==== Allocation Counting ====
+
+// Every replaceable form of operator new and delete goes through these two. They are kept
+// out of line so the compiler never sees free() applied to a pointer from operator new,
+// which -Wmismatched-new-delete reports once the replacements are inlined.
+atomic<size_t> allocations{0};
+
+[[gnu::noinline]] void* countedAllocate(size_t size, size_t alignment) noexcept {
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(max_align_t)) return malloc(size);
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+[[gnu::noinline]] void countedRelease(void* p) noexcept { free(p); }
+
+void* countedAllocateOrThrow(size_t size, size_t alignment) {
+    if (void* p = countedAllocate(size, alignment)) return p;
+    throw bad_alloc();
+}
+
+void* operator new(size_t size) { return countedAllocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return countedAllocateOrThrow(size, 0); }
+void* operator new(size_t size, align_val_t a) { return countedAllocateOrThrow(size, (size_t)a); }
+void* operator new[](size_t size, align_val_t a) { return countedAllocateOrThrow(size, (size_t)a); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return countedAllocate(size, 0); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return countedAllocate(size, 0); }
+void* operator new(size_t size, align_val_t a, const nothrow_t&) noexcept { return countedAllocate(size, (size_t)a); }
+void* operator new[](size_t size, align_val_t a, const nothrow_t&) noexcept { return countedAllocate(size, (size_t)a); }
+
+void operator delete(void* p) noexcept { countedRelease(p); }
+void operator delete[](void* p) noexcept { countedRelease(p); }
+void operator delete(void* p, size_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, size_t) noexcept { countedRelease(p); }
+void operator delete(void* p, align_val_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, align_val_t) noexcept { countedRelease(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { countedRelease(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { countedRelease(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { countedRelease(p); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { countedRelease(p); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { countedRelease(p); }
+
+// ==== Harness ====
+
+struct Options {
+    unsigned seed = 12345;
+    size_t maxSize = 1 << 20;
+    string filter;
+    string csv;
+    bool quick = false;
+};
+
+struct Result {
+    string name;
+    size_t size;
+    int runs;
+    double itemsPerSecond, p50Us, p99Us, allocationsPerOp;
+};
+
+Options options;
+vector<Result> results;
+
+double percentile(vector<double> v, double q) {
+    sort(v.begin(), v.end());
+    size_t i = (size_t)ceil(q * v.size());
+    return v[min(v.size() - 1, i ? i - 1 : 0)];
+}
+
+// Times op() repeatedly after one warm-up call; items is the work in one call. The number of
+// runs comes from the warm-up time: about half a second per size, between 5 and 200 runs.
+void measure(const string& name, size_t size, size_t items, const function<void()>& op) {
+    auto w0 = chrono::steady_clock::now();
+    op();
+    double warmUp = chrono::duration<double>(chrono::steady_clock::now() - w0).count();
+    double budget = options.quick ? 0.05 : 0.5;
+    int runs = (int)min(200.0, max(5.0, budget / max(warmUp, 1e-9)));
+    vector<double> us(runs);
+    size_t before = allocations.load();
+    for (int r = 0; r < runs; r++) {
+        auto t0 = chrono::steady_clock::now();
+        op();
+        us[r] = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+    }
+    double allocationsPerOp = (double)(allocations.load() - before) / runs;
+    double p50 = percentile(us, 0.5);
+    results.push_back({name, size, runs, items / (p50 / 1e6), p50, percentile(us, 0.99), allocationsPerOp});
+    const Result& r = results.back();
+    printf("%-26s %9zu %6d %14.0f %12.1f %12.1f %10.2f\n", r.name.c_str(), r.size, r.runs, r.itemsPerSecond, r.p50Us,
+           r.p99Us, r.allocationsPerOp);
+    fflush(stdout);
+}
+
+vector<size_t> sizes(size_t smallest) {
+    vector<size_t> s;
+    for (size_t n = smallest; n <= options.maxSize; n *= options.quick ? 16 : 4) s.push_back(n);
+    return s;
+}
+
+bool selected(const char* name) {
+    return options.filter.empty() || strstr(name, options.filter.c_str()) != nullptr;
+}
+
+// Each workload gets its own generator so adding a benchmark does not change the others
+mt19937 generator(const char* name, size_t size) {
+    seed_seq seq = {(unsigned)options.seed, (unsigned)size, (unsigned)hash<string>()(name)};
+    return mt19937(seq);
+}
+
+// ==== Benchmarks ====
+
+const int kWidth = 1024, kHeight = 1024;
+
+void benchmarkLines() {
+    const char* name = "bresenham_line";
+    if (!selected(name)) return;
+    Framebuffer fb(kWidth, kHeight);
+    fb.setColor(1, 1, 1);
+    for (size_t n : sizes(64)) {
+        auto g = generator(name, n);
+        uniform_int_distribution<int> coord(-64, kWidth + 63);
+        vector<int> p(n * 4);
+        for (auto& v : p) v = coord(g);
+        measure(name, n, n, [&] {
+            for (size_t i = 0; i < n; i++) bresenhamLine(fb, p[i * 4], p[i * 4 + 1], p[i * 4 + 2], p[i * 4 + 3]);
+        });
+    }
+}
+
+void benchmarkCircles() {
+    for (const char* name : {"midpoint_circle", "midpoint_ellipse"}) {
+        if (!selected(name)) continue;
+        bool ellipse = name[9] == 'e';
+        Framebuffer fb(kWidth, kHeight);
+        fb.setColor(1, 1, 1);
+        for (size_t n : sizes(64)) {
+            auto g = generator(name, n);
+            uniform_int_distribution<int> center(0, kWidth - 1), radius(1, 200);
+            vector<int> p(n * 4);
+            for (auto& v : p) v = center(g);
+            for (size_t i = 0; i < n; i++) p[i * 4 + 2] = radius(g), p[i * 4 + 3] = radius(g);
+            measure(name, n, n, [&] {
+                for (size_t i = 0; i < n; i++) {
+                    if (ellipse) midpointEllipse(fb, p[i * 4], p[i * 4 + 1], p[i * 4 + 2], p[i * 4 + 3]);
+                    else midpointCircle(fb, p[i * 4], p[i * 4 + 1], p[i * 4 + 2]);
+                }
+            });
+        }
+    }
+}
+
+// Star-shaped polygons of 8 to 24 vertices around random centers
+void randomPolygons(mt19937& g, size_t count, float extent, FillPolygons& polys) {
+    uniform_real_distribution<float> center(0, extent), radius(8, 64), jitter(0.5f, 1.0f);
+    uniform_int_distribution<int> sides(8, 24);
+    vector<Vec2f> pts;
+    polys.clear();
+    for (size_t i = 0; i < count; i++) {
+        float cx = center(g), cy = center(g), r = radius(g);
+        int n = sides(g);
+        pts.resize(n);
+        for (int k = 0; k < n; k++) {
+            float a = 2 * (float)M_PI * k / n, d = r * jitter(g);
+            pts[k] = {cx + d * cos(a), cy + d * sin(a)};
+        }
+        polys.addContour(pts.data(), n);
+        polys.endPolygon(Framebuffer::pack(jitter(g), jitter(g), jitter(g)));
+    }
+}
+
+void benchmarkScanlineFill() {
+    const char* name = "scanline_fill";
+    if (!selected(name)) return;
+    Framebuffer fb(kWidth, kHeight);
+    ScanlineFiller filler;
+    FillPolygons polys;
+    for (size_t n : sizes(16)) {
+        auto g = generator(name, n);
+        randomPolygons(g, n, kWidth, polys);
+        measure(name, n, n, [&] { filler.fill(fb, polys); });
+    }
+}
+
+void benchmarkLineClip() {
+    const char* name = "cohen_sutherland_batch";
+    if (!selected(name)) return;
+    ClipWindow window = {256, 256, 768, 768};
+    for (size_t n : sizes(256)) {
+        auto g = generator(name, n);
+        uniform_real_distribution<float> coord(0, kWidth);
+        SegmentBatch original;
+        for (size_t i = 0; i < n; i++) original.push_back(coord(g), coord(g), coord(g), coord(g));
+        SegmentBatch batch = original;
+        vector<uint8_t> status(n);
+        // Clipping is in place, so every run restores the input first (a copy, no allocation)
+        measure(name, n, n, [&] {
+            copy(original.x0.begin(), original.x0.end(), batch.x0.begin());
+            copy(original.y0.begin(), original.y0.end(), batch.y0.begin());
+            copy(original.x1.begin(), original.x1.end(), batch.x1.begin());
+            copy(original.y1.begin(), original.y1.end(), batch.y1.begin());
+            clipSegments(batch, window, status.data());
+        });
+    }
+}
+
+void benchmarkPolygonClip() {
+    const char* name = "sutherland_hodgman_batch";
+    if (!selected(name)) return;
+    Vec2f hexagon[6];
+    for (int k = 0; k < 6; k++)
+        hexagon[k] = {512 + 300 * cos((float)M_PI * k / 3), 512 + 300 * sin((float)M_PI * k / 3)};
+    ConvexClipWindow window;
+    window.setPolygon(hexagon, 6);
+    PolygonClipArena arena;
+    ClippedPolygons out;
+    FillPolygons polys;
+    for (size_t n : sizes(16)) {
+        auto g = generator(name, n);
+        randomPolygons(g, n, kWidth, polys);
+        measure(name, n, n, [&] {
+            out.clear();
+            clipPolygons(polys.vertices.data(), polys.contours.data(), n, window, arena, out);
+        });
+    }
+}
+
+void benchmarkCurves() {
+    for (TessellationMode mode : {TESSELLATE_ADAPTIVE, TESSELLATE_FORWARD_DIFFERENCE}) {
+        const char* name = mode == TESSELLATE_ADAPTIVE ? "bezier_adaptive" : "bezier_forward_diff";
+        if (!selected(name)) continue;
+        CurveTessellator tessellator;
+        tessellator.mode = mode;
+        vector<Vec2f> vertices;
+        for (size_t n : sizes(16)) {
+            auto g = generator(name, n);
+            uniform_real_distribution<float> coord(0, kWidth);
+            CurveBatch batch;
+            for (size_t i = 0; i < n; i++)
+                batch.addBezier(Vec2f{coord(g), coord(g)}, Vec2f{coord(g), coord(g)}, Vec2f{coord(g), coord(g)},
+                                Vec2f{coord(g), coord(g)});
+            vertices.resize(tessellator.tessellate(batch, nullptr, 0));
+            measure(name, n, n, [&] { tessellator.tessellate(batch, vertices.data(), vertices.size()); });
+        }
+    }
+}
+
+void benchmarkTransforms() {
+    if (selected("transform_2d")) {
+        TransformStack2D t;
+        t.translate(3, 4);
+        t.rotate(0.3f);
+        t.scale(1.5f, 0.5f);
+        for (size_t n : sizes(1024)) {
+            auto g = generator("transform_2d", n);
+            uniform_real_distribution<float> coord(-1, 1);
+            VertexArray2 in, out;
+            for (size_t i = 0; i < n; i++) in.push_back(coord(g), coord(g));
+            out.resize(n);
+            measure("transform_2d", n, n, [&] { transformVertices(t.matrix(), in, out); });
+        }
+    }
+    if (selected("transform_3d")) {
+        TransformStack3D t;
+        t.translate(1, 2, 3);
+        t.rotateX(0.3f);
+        t.rotateY(0.7f);
+        t.scale(2, 2, 2);
+        for (size_t n : sizes(1024)) {
+            auto g = generator("transform_3d", n);
+            uniform_real_distribution<float> coord(-1, 1);
+            VertexArray3 in, out;
+            for (size_t i = 0; i < n; i++) in.push_back(coord(g), coord(g), coord(g));
+            out.resize(n);
+            measure("transform_3d", n, n, [&] { transformVertices(t.matrix(), in, out); });
+        }
+    }
+}
+
+void benchmarkRasterizer() {
+    const char* name = "zbuffer_triangles";
+    if (!selected(name)) return;
+    Framebuffer fb(kWidth, kHeight);
+    SoftwareRasterizer rasterizer;
+    rasterizer.cullBackFaces = false;
+    Mat4 mvp = Mat4::orthographic(0, kWidth, 0, kHeight, -1, 1);
+    for (size_t n : sizes(64)) {
+        auto g = generator(name, n);
+        uniform_real_distribution<float> coord(0, kWidth), offset(-24, 24), depth(-0.9f, 0.9f);
+        RasterMesh mesh;
+        for (size_t i = 0; i < n; i++) {
+            float cx = coord(g), cy = coord(g), z = depth(g);
+            for (int k = 0; k < 3; k++) {
+                mesh.positions.push_back(cx + offset(g), cy + offset(g), z);
+                mesh.indices.push_back((uint32_t)(i * 3 + k));
+            }
+            mesh.colors.push_back(Framebuffer::pack(0.5f, 0.5f, z * 0.5f + 0.5f));
+        }
+        measure(name, n, n, [&] { rasterizer.draw(fb, mesh, mvp, ENGINE_ZBUFFER); });
+    }
+}
+
+// ==== Main ====
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--quick") options.quick = true;
+        else if (i + 1 < argc && arg == "--seed") options.seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && arg == "--max-size") options.maxSize = strtoull(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && arg == "--filter") options.filter = argv[++i];
+        else if (i + 1 < argc && arg == "--csv") options.csv = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--seed N] [--max-size N] [--filter NAME] [--csv FILE] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("seed %u, sizes up to %zu, instrumentation %s\n", options.seed, options.maxSize,
+           instrumentationEnabled() ? "on" : "off");
+    printf("%-26s %9s %6s %14s %12s %12s %10s\n", "benchmark", "size", "runs", "items/s", "p50 us", "p99 us",
+           "allocs/op");
+    benchmarkLines();
+    benchmarkCircles();
+    benchmarkScanlineFill();
+    benchmarkLineClip();
+    benchmarkPolygonClip();
+    benchmarkCurves();
+    benchmarkTransforms();
+    benchmarkRasterizer();
+
+    if (instrumentationEnabled()) {
+        printf("\n");
+        reportProbes();
+    }
+
+    if (!options.csv.empty()) {
+        FILE* f = fopen(options.csv.c_str(), "w");
+        if (!f) {
+            fprintf(stderr, "Could not write %s\n", options.csv.c_str());
+            return 1;
+        }
+        fprintf(f, "benchmark,size,runs,items_per_second,p50_us,p99_us,allocations_per_op\n");
+        for (auto& r : results)
+            fprintf(f, "%s,%zu,%d,%.1f,%.3f,%.3f,%.3f\n", r.name.c_str(), r.size, r.runs, r.itemsPerSecond, r.p50Us,
+                    r.p99Us, r.allocationsPerOp);
+        if (fclose(f) != 0) return 1;
+    }
+    return 0;
+}
@@ -2,63 +2,31 @@
 
 #include <GL/glut.h>
 #include <iostream>
+#include "Framebuffer.h"
+#include "FramebufferGL.h"
+#include "RasterPrimitives.h"
 using namespace std;
 
 int x1, y1, x2, y2;
 
-void plot(int x, int y) {
-    glBegin(GL_POINTS);
-    glVertex2i(x, y);
-    glEnd();
-}
-
-void bresenhamLine(int x1, int y1, int x2, int y2) {
-    int dx = abs(x2 - x1);
-    int dy = abs(y2 - y1);
-
-    int sx = (x2 >= x1) ? 1 : -1;
-    int sy = (y2 >= y1) ? 1 : -1;
-
-    bool swap = false;
-
-    if (dy > dx) {
-        std::swap(dx, dy);
-        swap = true;
-    }
-
-    int p = 2 * dy - dx;
-    int x = x1, y = y1;
+// The line is rasterized into memory and uploaded once per frame
+Framebuffer framebuffer(500, 500);
 
-    for (int i = 0; i <= dx; i++) {
-        plot(x, y);
-
-        if (p >= 0) {
-            if (swap)
-                x += sx;
-            else
-                y += sy;
-            p -= 2 * dx;
-        }
-
-        if (swap)
-            y += sy;
-        else
-            x += sx;
-
-        p += 2 * dy;
-    }
+void renderScene() {
+    framebuffer.clear(1, 1, 1);     // White background
+    framebuffer.setColor(1, 0, 0);  // Red line
+    bresenhamLine(framebuffer, x1, y1, x2, y2);  // RasterPrimitives.h
 }
 
 void display() {
     glClear(GL_COLOR_BUFFER_BIT);
-    glColor3f(1, 0, 0);  // Red line
-    bresenhamLine(x1, y1, x2, y2);
+    renderScene();
+    GLUTTarget().present(framebuffer);
     glFlush();
 }
 
 void init() {
     glClearColor(1, 1, 1, 1);  // White background
-    glColor3f(0, 0, 0);        // Black drawing color
     gluOrtho2D(0, 500, 0, 500); // 2D coordinate system
 }
 
@@ -68,6 +36,13 @@ int main(int argc, char** argv) {
     cout << "Enter ending point (x2 y2): ";
     cin >> x2 >> y2;
 
+    // "-o line.png" renders without a window
+    string output = headlessOutput(argc, argv);
+    if (!output.empty()) {
+        renderScene();
+        return makeFileTarget(output)->present(framebuffer) ? 0 : 1;
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(500, 500);
@@ -2,6 +2,12 @@
 
 #include <GL/glut.h>
 #include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "LineClipBatch.h"
 using namespace std;
 
 // Define the clipping window boundaries
@@ -40,8 +46,8 @@ int computeOutcode(int x, int y) {
     return code;
 }
 
-// Cohen-Sutherland Line Clipping Algorithm
-void cohenSutherlandClip(int &x1, int &y1, int &x2, int &y2) {
+// Cohen-Sutherland Line Clipping Algorithm; returns true if part of the line is visible
+bool cohenSutherlandClip(int &x1, int &y1, int &x2, int &y2) {
     int outcode1 = computeOutcode(x1, y1);
     int outcode2 = computeOutcode(x2, y2);
     bool accept = false;
@@ -84,12 +90,226 @@ void cohenSutherlandClip(int &x1, int &y1, int &x2, int &y2) {
         }
     }
 
-    if (accept) {
-        glBegin(GL_LINES);
-        glVertex2i(x1, y1);
-        glVertex2i(x2, y2);
-        glEnd();
+    return accept;
+}
+
+// ==== Verification ====
+
+// Clips every segment with the single-segment clipSegment, the reference for clipSegments
+void clipEachSegment(SegmentBatch& s, const ClipWindow& w, vector<uint8_t>& status) {
+    status.resize(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        bool inside = !(segmentOutcode(s.x0[i], s.y0[i], w) | segmentOutcode(s.x1[i], s.y1[i], w));
+        bool visible = clipSegment(s.x0[i], s.y0[i], s.x1[i], s.y1[i], w);
+        status[i] = inside ? SEGMENT_INSIDE : visible ? SEGMENT_CLIPPED : SEGMENT_REJECTED;
+    }
+}
+
+// Clipped end points must stay on or inside the window, up to float rounding
+bool insideWindow(float x, float y, const ClipWindow& w) {
+    float eps = 1e-5f * max(w.xmax - w.xmin, w.ymax - w.ymin);
+    return x >= w.xmin - eps && x <= w.xmax + eps && y >= w.ymin - eps && y <= w.ymax + eps;
+}
+
+// clipSegments against the scalar loop: the same status and bit-identical end points
+size_t compareWithScalar(const SegmentBatch& input, const ClipWindow& w) {
+    SegmentBatch batch = input, scalar = input;
+    vector<uint8_t> status(input.size()), expected;
+    clipSegments(batch, w, status.data());
+    clipEachSegment(scalar, w, expected);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < input.size(); i++) {
+        if (status[i] != expected[i]) {
+            mismatches++;
+            continue;
+        }
+        if (status[i] == SEGMENT_REJECTED) continue;
+        if (batch.x0[i] != scalar.x0[i] || batch.y0[i] != scalar.y0[i] ||
+            batch.x1[i] != scalar.x1[i] || batch.y1[i] != scalar.y1[i] ||
+            !insideWindow(batch.x0[i], batch.y0[i], w) || !insideWindow(batch.x1[i], batch.y1[i], w))
+            mismatches++;
+    }
+    return mismatches;
+}
+
+// Segments passing within a hair of a window corner, where rounding decides which edge is hit
+void addCornerGrazingSegments(SegmentBatch& s, const ClipWindow& w, size_t count, mt19937& rng) {
+    uniform_real_distribution<float> unit(0.0f, 1.0f), nudge(-1e-4f, 1e-4f);
+    float cornersX[4] = {w.xmin, w.xmax, w.xmax, w.xmin}, cornersY[4] = {w.ymin, w.ymin, w.ymax, w.ymax};
+    float size = max(w.xmax - w.xmin, w.ymax - w.ymin);
+    for (size_t i = 0; i < count; i++) {
+        int c = rng() % 4;
+        float px = cornersX[c] + nudge(rng) * size, py = cornersY[c] + nudge(rng) * size;
+        float angle = unit(rng) * 6.2831853f;
+        float a = unit(rng) * size, b = unit(rng) * size;
+        s.push_back(px - a * cosf(angle), py - a * sinf(angle), px + b * cosf(angle), py + b * sinf(angle));
+    }
+}
+
+// Horizontal and vertical segments, including ones lying on the window edges
+size_t checkAxisParallel(const ClipWindow& w) {
+    float xs[] = {w.xmin - 50, w.xmin, (w.xmin + w.xmax) / 2, w.xmax, w.xmax + 50};
+    float ys[] = {w.ymin - 50, w.ymin, (w.ymin + w.ymax) / 2, w.ymax, w.ymax + 50};
+    size_t mismatches = 0;
+    for (float y : ys) {
+        float x0 = w.xmin - 100, y0 = y, x1 = w.xmax + 100, y1 = y;
+        bool visible = clipSegment(x0, y0, x1, y1, w);
+        bool expected = y >= w.ymin && y <= w.ymax;
+        if (visible != expected || (visible && (x0 != w.xmin || x1 != w.xmax || y0 != y || y1 != y))) mismatches++;
+    }
+    for (float x : xs) {
+        float x0 = x, y0 = w.ymax + 100, x1 = x, y1 = w.ymin - 100;
+        bool visible = clipSegment(x0, y0, x1, y1, w);
+        bool expected = x >= w.xmin && x <= w.xmax;
+        if (visible != expected || (visible && (y0 != w.ymax || y1 != w.ymin || x0 != x || x1 != x))) mismatches++;
+    }
+    return mismatches;
+}
+
+// Liang-Barsky in exact integer arithmetic: each edge crossing is kept as the fraction q / p of
+// the segment, so visibility is decided without rounding. The independent reference for both
+// clippers on integer input; the end points are only rounded when written out.
+bool clipExactly(int x0, int y0, int x1, int y1, double out[4]) {
+    long long dx = x1 - x0, dy = y1 - y0;
+    long long p[4] = {-dx, dx, -dy, dy};
+    long long q[4] = {x0 - xmin, xmax - x0, y0 - ymin, ymax - y0};
+    long long enterNum = 0, enterDen = 1, leaveNum = 1, leaveDen = 1;
+    for (int k = 0; k < 4; k++) {
+        if (p[k] == 0) {
+            if (q[k] < 0) return false;
+        } else if (p[k] < 0) {
+            if (-q[k] * enterDen > enterNum * -p[k]) enterNum = -q[k], enterDen = -p[k];
+        } else if (q[k] * leaveDen < leaveNum * p[k]) {
+            leaveNum = q[k], leaveDen = p[k];
+        }
+    }
+    if (enterNum * leaveDen > leaveNum * enterDen) return false;
+    double t0 = (double)enterNum / enterDen, t1 = (double)leaveNum / leaveDen;
+    out[0] = x0 + dx * t0; out[1] = y0 + dy * t0;
+    out[2] = x0 + dx * t1; out[3] = y0 + dy * t1;
+    return true;
+}
+
+// Distance from a segment to the nearest window corner
+double distanceToCorner(int x0, int y0, int x1, int y1) {
+    int cornersX[4] = {xmin, xmax, xmax, xmin}, cornersY[4] = {ymin, ymin, ymax, ymax};
+    double dx = x1 - x0, dy = y1 - y0, nearest = INFINITY;
+    for (int c = 0; c < 4; c++) {
+        double t = ((cornersX[c] - x0) * dx + (cornersY[c] - y0) * dy) / (dx * dx + dy * dy);
+        t = dx == 0 && dy == 0 ? 0 : max(0.0, min(1.0, t));
+        nearest = min(nearest, hypot(x0 + dx * t - cornersX[c], y0 + dy * t - cornersY[c]));
+    }
+    return nearest;
+}
+
+// Checks the batched clipper; returns 0 when every check passes
+int verifyBatchClipper(size_t count) {
+    mt19937 rng(12345);
+    size_t failures = 0;
+
+    // A segment that used to bounce between the top and left edges forever
+    {
+        ClipWindow w = {0.1f, 0.3f, 0.7f, 0.9f};
+        SegmentBatch s;
+        s.push_back(0.481231093f, 0.658199847f, -0.281230241f, -0.0581989624f);
+        size_t m = compareWithScalar(s, w);
+        cout << "corner regression: " << m << " mismatches\n";
+        failures += m;
+    }
+
+    // The vector lanes only sort segments into inside, rejected and straddling; straddling ones
+    // go through clipSegment. This checks that sorting on random float windows, corner-grazing
+    // segments and segments anywhere around the window. The clipping itself is checked below.
+    {
+        uniform_real_distribution<float> unit(0.0f, 1.0f), around(-0.5f, 1.5f);
+        size_t m = 0, total = 0;
+        for (int round = 0; round < 64; round++) {
+            float ax = unit(rng), bx = unit(rng), ay = unit(rng), by = unit(rng);
+            ClipWindow w = {min(ax, bx), min(ay, by), max(ax, bx) + 1e-3f, max(ay, by) + 1e-3f};
+            SegmentBatch s;
+            addCornerGrazingSegments(s, w, count / 128 + 1, rng);
+            for (size_t i = 0; i < count / 128 + 1; i++)
+                s.push_back(around(rng), around(rng), around(rng), around(rng));
+            m += compareWithScalar(s, w) + checkAxisParallel(w);
+            total += s.size();
+        }
+        cout << total << " float segments, vector lanes against clipSegment: " << m << " mismatches\n";
+        failures += m;
+    }
+
+    // Integer segments against cohenSutherlandClip and the exact clipper: short ones like map
+    // overlay edges and long ones crossing the window, both anywhere around its corners
+    uniform_int_distribution<int> coord(0, 500), shortOffset(-40, 40), longOffset(-600, 600);
+    vector<int> ref(count * 4);
+    SegmentBatch batch;
+    batch.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        auto& offset = i % 2 ? longOffset : shortOffset;
+        ref[i * 4 + 0] = coord(rng);
+        ref[i * 4 + 1] = coord(rng);
+        ref[i * 4 + 2] = ref[i * 4 + 0] + offset(rng);
+        ref[i * 4 + 3] = ref[i * 4 + 1] + offset(rng);
+        batch.x0[i] = ref[i * 4 + 0]; batch.y0[i] = ref[i * 4 + 1];
+        batch.x1[i] = ref[i * 4 + 2]; batch.y1[i] = ref[i * 4 + 3];
+    }
+    vector<int> original = ref;
+    ClipWindow window = {xmin, ymin, xmax, ymax};
+    size_t exact = compareWithScalar(batch, window);
+
+    auto t0 = chrono::steady_clock::now();
+    vector<bool> refAccept(count);
+    for (size_t i = 0; i < count; i++)
+        refAccept[i] = cohenSutherlandClip(ref[i * 4], ref[i * 4 + 1], ref[i * 4 + 2], ref[i * 4 + 3]);
+    auto t1 = chrono::steady_clock::now();
+    vector<uint8_t> status(count);
+    size_t visible = clipSegments(batch, window, status.data());
+    auto t2 = chrono::steady_clock::now();
+
+    size_t mismatches = 0, truncated = 0;
+    for (size_t i = 0; i < count; i++) {
+        const int* in = &original[i * 4];
+        double e[4];
+        bool accepted = status[i] != SEGMENT_REJECTED;
+        bool exactAccept = clipExactly(in[0], in[1], in[2], in[3], e);
+
+        // Accept or reject must be the same as cohenSutherlandClip's, except where truncating an
+        // intersection moves it across a window corner the segment passes within a pixel of;
+        // there clipSegments must decide as exact arithmetic does
+        if (accepted != exactAccept) {
+            mismatches++;
+            continue;
+        }
+        if (accepted != refAccept[i]) {
+            if (distanceToCorner(in[0], in[1], in[2], in[3]) > 1) mismatches++;
+            else truncated++;
+            continue;
+        }
+        if (!accepted) continue;
+
+        // End points: within float rounding of the exact ones and within the reference's
+        // truncation error, both of which the slope magnifies
+        double dx = abs(in[2] - in[0]), dy = abs(in[3] - in[1]);
+        double steepness = dx == 0 || dy == 0 ? 0 : max(dx / dy, dy / dx);
+        double rounding = 1e-3 * (1 + steepness), tolerance = 2 * (1 + steepness);
+        float got[4] = {batch.x0[i], batch.y0[i], batch.x1[i], batch.y1[i]};
+        for (int k = 0; k < 4; k++)
+            if (fabs(got[k] - e[k]) > rounding || fabs(got[k] - ref[i * 4 + k]) > tolerance) {
+                mismatches++;
+                break;
+            }
     }
+    failures += exact + mismatches;
+
+    double scalarMs = chrono::duration<double, milli>(t1 - t0).count();
+    double batchMs = chrono::duration<double, milli>(t2 - t1).count();
+    cout << count << " integer segments, " << visible << " visible, " << exact
+         << " mismatches against clipSegment, " << mismatches
+         << " against cohenSutherlandClip and exact clipping (" << truncated
+         << " corners cohenSutherlandClip decides wrongly by truncation)\n"
+         << "cohenSutherlandClip: " << scalarMs << " ms, clipSegments: " << batchMs << " ms ("
+         << count / (batchMs * 1e3) << " M segments/s)\n";
+    return failures == 0 ? 0 : 1;
 }
 
 void display() {
@@ -108,7 +328,12 @@ void display() {
     glEnd();
 
     // Apply Cohen-Sutherland clipping
-    cohenSutherlandClip(x1, y1, x2, y2);
+    if (cohenSutherlandClip(x1, y1, x2, y2)) {
+        glBegin(GL_LINES);
+        glVertex2i(x1, y1);
+        glVertex2i(x2, y2);
+        glEnd();
+    }
 
     glFlush();
 }
@@ -120,6 +345,10 @@ void init() {
 }
 
 int main(int argc, char** argv) {
+    // "--verify [count]" checks the batched clipper without opening a window
+    if (argc > 1 && strcmp(argv[1], "--verify") == 0)
+        return verifyBatchClipper(argc > 2 ? stoul(argv[2]) : 1000000);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(500, 500);
@@ -0,0 +1,164 @@
+/* Curve tessellation for cubic Hermite and Bezier splines.
+Curves are collected into a CurveBatch as Bezier control points (Hermite segments are
+converted once on insertion); piecewise splines share the end point of one segment with the
+start of the next. The tessellator emits one polyline per spline into a caller-provided
+buffer, either by flatness-driven adaptive subdivision or by forward differencing with a
+step count derived from the same tolerance. Every polyline ends exactly on the last control
+point. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Geometry.h"
+#include "Instrumentation.h"
+
+// ==== Curve Batch ====
+
+// Splines stored back to back; spline j uses points[splines[j] .. splines[j + 1]), which is
+// 3k + 1 points for k cubic segments
+struct CurveBatch {
+    std::vector<Vec2f> points;
+    std::vector<uint32_t> splines = {0};
+
+    size_t count() const { return splines.size() - 1; }
+
+    template <class P>
+    void addBezier(P p0, P p1, P p2, P p3) {
+        P pts[4] = {p0, p1, p2, p3};
+        addBezierSpline(pts, 1);
+    }
+
+    // 3 * segments + 1 control points; segment i is pts[3i .. 3i + 3]
+    template <class P>
+    void addBezierSpline(const P* pts, size_t segments) {
+        for (size_t i = 0; i < 3 * segments + 1; i++) points.push_back({(float)pts[i].x, (float)pts[i].y});
+        splines.push_back((uint32_t)points.size());
+    }
+
+    template <class P>
+    void addHermite(P p0, P p1, P r0, P r1) {
+        P pts[2] = {p0, p1}, tangents[2] = {r0, r1};
+        addHermiteSpline(pts, tangents, 2);
+    }
+
+    // Curve through n points with the given tangents; segment i runs from pts[i] to pts[i + 1]
+    template <class P>
+    void addHermiteSpline(const P* pts, const P* tangents, size_t n) {
+        if (n < 2) return;
+        points.push_back({(float)pts[0].x, (float)pts[0].y});
+        for (size_t i = 0; i + 1 < n; i++) {
+            Vec2f p0 = {(float)pts[i].x, (float)pts[i].y}, p1 = {(float)pts[i + 1].x, (float)pts[i + 1].y};
+            Vec2f r0 = {(float)tangents[i].x, (float)tangents[i].y};
+            Vec2f r1 = {(float)tangents[i + 1].x, (float)tangents[i + 1].y};
+            // Hermite tangents are three times the Bezier handle vectors
+            points.push_back(p0 + (1.0f / 3) * r0);
+            points.push_back(p1 - (1.0f / 3) * r1);
+            points.push_back(p1);
+        }
+        splines.push_back((uint32_t)points.size());
+    }
+
+    void clear() {
+        points.clear();
+        splines.resize(1);
+    }
+};
+
+// ==== Tessellator ====
+
+enum TessellationMode { TESSELLATE_ADAPTIVE, TESSELLATE_FORWARD_DIFFERENCE };
+
+struct CurveTessellator {
+    TessellationMode mode = TESSELLATE_ADAPTIVE;
+    float tolerance = 0.25f;  // largest allowed distance between polyline and curve
+    int maxDepth = 16;        // adaptive subdivision limit (at most 2^maxDepth pieces)
+
+    // Writes the polyline of every spline in the batch to out, back to back; strips[j] (if
+    // given, batch.count() + 1 entries) receives where polyline j starts. Returns the number
+    // of vertices needed; nothing past capacity is written, so a call with capacity 0 sizes
+    // the buffer.
+    size_t tessellate(const CurveBatch& batch, Vec2f* out, size_t capacity, uint32_t* strips = nullptr) const {
+        GRAPHICS_TIMED_SCOPE("curve.tessellate");
+        Emitter emit = {out, capacity, 0};
+        for (size_t j = 0; j < batch.count(); j++) {
+            if (strips) strips[j] = (uint32_t)emit.count;
+            const Vec2f* p = batch.points.data() + batch.splines[j];
+            size_t segments = (batch.splines[j + 1] - batch.splines[j]) / 3;
+            emit(p[0]);
+            for (size_t s = 0; s < segments; s++, p += 3) {
+                if (mode == TESSELLATE_ADAPTIVE) subdivide(p, emit);
+                else forwardDifference(p, emit);
+            }
+        }
+        if (strips) strips[batch.count()] = (uint32_t)emit.count;
+        GRAPHICS_COUNT("curve.vertices", emit.count);
+        return emit.count;
+    }
+
+    // Number of steps forward differencing uses for one segment (Wang's formula)
+    int segmentSteps(const Vec2f* p) const {
+        Vec2f d0 = p[0] - 2.0f * p[1] + p[2], d1 = p[1] - 2.0f * p[2] + p[3];
+        float m = std::sqrt(std::max(d0.x * d0.x + d0.y * d0.y, d1.x * d1.x + d1.y * d1.y));
+        int n = (int)std::ceil(std::sqrt(0.75f * m / tolerance));
+        return std::min(std::max(n, 1), 1 << maxDepth);
+    }
+
+private:
+    struct Emitter {
+        Vec2f* out;
+        size_t capacity, count;
+
+        void operator()(Vec2f v) {
+            if (count < capacity) out[count] = v;
+            count++;
+        }
+    };
+
+    // Control polygon is within tolerance of the chord (Willcocks' bound)
+    bool flat(const Vec2f* p) const {
+        float ux = 3 * p[1].x - 2 * p[0].x - p[3].x, uy = 3 * p[1].y - 2 * p[0].y - p[3].y;
+        float vx = 3 * p[2].x - p[0].x - 2 * p[3].x, vy = 3 * p[2].y - p[0].y - 2 * p[3].y;
+        return std::max(ux * ux, vx * vx) + std::max(uy * uy, vy * vy) <= 16 * tolerance * tolerance;
+    }
+
+    // de Casteljau subdivision; emits the end point of every flat piece in order
+    void subdivide(const Vec2f* p, Emitter& emit, int depth = 0) const {
+        if (depth >= maxDepth || flat(p)) {
+            emit(p[3]);
+            return;
+        }
+        Vec2f p01 = 0.5f * (p[0] + p[1]), p12 = 0.5f * (p[1] + p[2]), p23 = 0.5f * (p[2] + p[3]);
+        Vec2f p012 = 0.5f * (p01 + p12), p123 = 0.5f * (p12 + p23);
+        Vec2f mid = 0.5f * (p012 + p123);
+        Vec2f left[4] = {p[0], p01, p012, mid}, right[4] = {mid, p123, p23, p[3]};
+        subdivide(left, emit, depth + 1);
+        subdivide(right, emit, depth + 1);
+    }
+
+    // Steps the cubic with three additions per vertex; the last vertex is the exact end point
+    void forwardDifference(const Vec2f* p, Emitter& emit) const {
+        int n = segmentSteps(p);
+        // Power basis: a t^3 + b t^2 + c t + d
+        Vec2f a = (-1.0f * p[0]) + 3.0f * p[1] - 3.0f * p[2] + p[3];
+        Vec2f b = 3.0f * p[0] - 6.0f * p[1] + 3.0f * p[2];
+        Vec2f c = -3.0f * p[0] + 3.0f * p[1];
+        float h = 1.0f / n, h2 = h * h, h3 = h2 * h;
+
+        Vec2f f = p[0];
+        Vec2f df = h3 * a + h2 * b + h * c;
+        Vec2f d2f = (6 * h3) * a + (2 * h2) * b;
+        Vec2f d3f = (6 * h3) * a;
+        for (int i = 1; i < n; i++) {
+            f = f + df;
+            df = df + d2f;
+            d2f = d2f + d3f;
+            emit(f);
+        }
+        emit(p[3]);
+    }
+};
@@ -0,0 +1,237 @@
+/* Framebuffer: headless RGBA8 render target for the raster programs.
+The drawing algorithms write pixels and spans straight into a contiguous, cache-aligned
+buffer; a RenderTarget backend then presents the finished image (PPM/PNG file, or the
+GLUT window through FramebufferGL.h). Row 0 is the bottom row, matching gluOrtho2D. */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ==== Framebuffer ====
+
+class Framebuffer {
+public:
+    static const int kAlignment = 64;  // one cache line
+
+    Framebuffer() = default;
+    Framebuffer(int w, int h) { resize(w, h); }
+
+    Framebuffer(Framebuffer&&) = default;
+    Framebuffer& operator=(Framebuffer&&) = default;
+
+    // Rows are padded so every row starts on a cache line
+    void resize(int w, int h) {
+        width = w;
+        height = h;
+        stride = (w + kPixelsPerLine - 1) / kPixelsPerLine * kPixelsPerLine;
+        size_t bytes = (size_t)stride * h * sizeof(uint32_t);
+        bytes = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+        storage.reset(static_cast<uint32_t*>(std::aligned_alloc(kAlignment, bytes ? bytes : kAlignment)));
+        clear(0.0f, 0.0f, 0.0f);
+    }
+
+    // Pack a color the same way glColor3f takes it; bytes are R, G, B, A in memory
+    static uint32_t pack(float r, float g, float b, float a = 1.0f) {
+        uint8_t bytes[4] = {toByte(r), toByte(g), toByte(b), toByte(a)};
+        uint32_t c;
+        std::memcpy(&c, bytes, 4);
+        return c;
+    }
+
+    void setColor(float r, float g, float b) { color = pack(r, g, b); }
+    void setColor(uint32_t c) { color = c; }
+
+    void clear(float r, float g, float b) { clear(pack(r, g, b)); }
+    void clear(uint32_t c) {
+        for (int y = 0; y < height; y++)
+            std::fill_n(row(y), width, c);
+    }
+
+    uint32_t* row(int y) { return storage.get() + (size_t)y * stride; }
+    const uint32_t* row(int y) const { return storage.get() + (size_t)y * stride; }
+    uint32_t* data() { return storage.get(); }
+    const uint32_t* data() const { return storage.get(); }
+
+    // Single pixel in the current color; out-of-range pixels are discarded
+    void plot(int x, int y) {
+        if ((unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height)
+            row(y)[x] = color;
+    }
+
+    // Horizontal span [x0, x1] on row y in the current color, clipped to the buffer
+    void span(int x0, int x1, int y) { span(x0, x1, y, color); }
+
+    // Same with an explicit color, for callers filling rows from several threads
+    void span(int x0, int x1, int y, uint32_t c) {
+        if ((unsigned)y >= (unsigned)height) return;
+        if (x0 > x1) std::swap(x0, x1);
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, width - 1);
+        if (x0 <= x1) std::fill(row(y) + x0, row(y) + x1 + 1, c);
+    }
+
+    int width = 0, height = 0;
+    int stride = 0;      // pixels per row including padding
+    uint32_t color = 0;  // current drawing color (packed RGBA)
+
+private:
+    static const int kPixelsPerLine = kAlignment / sizeof(uint32_t);
+
+    static uint8_t toByte(float v) {
+        return (uint8_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    struct FreeDeleter {
+        void operator()(uint32_t* p) const { std::free(p); }
+    };
+    std::unique_ptr<uint32_t, FreeDeleter> storage;
+};
+
+// ==== Image Output ====
+
+// Binary PPM (P6), top row first
+inline bool writePPM(const Framebuffer& fb, const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    std::fprintf(f, "P6\n%d %d\n255\n", fb.width, fb.height);
+    std::vector<uint8_t> line((size_t)fb.width * 3);
+    for (int y = fb.height - 1; y >= 0; y--) {
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(fb.row(y));
+        for (int x = 0; x < fb.width; x++) {
+            line[x * 3 + 0] = src[x * 4 + 0];
+            line[x * 3 + 1] = src[x * 4 + 1];
+            line[x * 3 + 2] = src[x * 4 + 2];
+        }
+        std::fwrite(line.data(), 1, line.size(), f);
+    }
+    return std::fclose(f) == 0;
+}
+
+namespace png_detail {
+
+inline uint32_t crc32(const uint8_t* data, size_t n, uint32_t crc = 0) {
+    // Built once on first use; a function-local static is initialized thread-safely
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+inline void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(v >> 24); out.push_back(v >> 16); out.push_back(v >> 8); out.push_back(v);
+}
+
+inline void writeChunk(FILE* f, const char* type, const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> chunk;
+    putBE32(chunk, (uint32_t)body.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), body.begin(), body.end());
+    uint32_t crc = crc32(chunk.data() + 4, chunk.size() - 4);
+    putBE32(chunk, crc);
+    std::fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+}  // namespace png_detail
+
+// RGBA PNG, top row first. The zlib stream uses stored (uncompressed) deflate blocks so
+// there is no dependency on zlib.
+inline bool writePNG(const Framebuffer& fb, const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::fwrite(signature, 1, 8, f);
+
+    std::vector<uint8_t> ihdr;
+    png_detail::putBE32(ihdr, fb.width);
+    png_detail::putBE32(ihdr, fb.height);
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});  // 8-bit RGBA, no interlace
+    png_detail::writeChunk(f, "IHDR", ihdr);
+
+    // Filtered scanlines: a zero filter byte followed by the raw row
+    size_t rowBytes = (size_t)fb.width * 4;
+    std::vector<uint8_t> raw;
+    raw.reserve((rowBytes + 1) * fb.height);
+    for (int y = fb.height - 1; y >= 0; y--) {
+        raw.push_back(0);
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(fb.row(y));
+        raw.insert(raw.end(), src, src + rowBytes);
+    }
+
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    size_t pos = 0;
+    do {
+        size_t len = std::min<size_t>(raw.size() - pos, 65535);
+        bool last = pos + len == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(len & 0xFF); idat.push_back(len >> 8);
+        idat.push_back(~len & 0xFF); idat.push_back((~len >> 8) & 0xFF);
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+    png_detail::putBE32(idat, (b << 16) | a);
+    png_detail::writeChunk(f, "IDAT", idat);
+    png_detail::writeChunk(f, "IEND", {});
+    return std::fclose(f) == 0;
+}
+
+// ==== Render Targets ====
+
+// Backend that receives the finished framebuffer
+class RenderTarget {
+public:
+    virtual ~RenderTarget() = default;
+    virtual bool present(const Framebuffer& fb) = 0;
+};
+
+class PPMTarget : public RenderTarget {
+public:
+    explicit PPMTarget(std::string path) : path(std::move(path)) {}
+    bool present(const Framebuffer& fb) override { return writePPM(fb, path); }
+
+private:
+    std::string path;
+};
+
+class PNGTarget : public RenderTarget {
+public:
+    explicit PNGTarget(std::string path) : path(std::move(path)) {}
+    bool present(const Framebuffer& fb) override { return writePNG(fb, path); }
+
+private:
+    std::string path;
+};
+
+// Pick a file backend from the extension (.png, anything else is PPM)
+inline std::unique_ptr<RenderTarget> makeFileTarget(const std::string& path) {
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0)
+        return std::unique_ptr<RenderTarget>(new PNGTarget(path));
+    return std::unique_ptr<RenderTarget>(new PPMTarget(path));
+}
+
+// Returns the file named by "-o <file>" on the command line, or "" for the GLUT window
+inline std::string headlessOutput(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i++)
+        if (std::strcmp(argv[i], "-o") == 0) return argv[i + 1];
+    return "";
+}
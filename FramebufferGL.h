@@ -0,0 +1,35 @@
+/* GLUT backend for Framebuffer: uploads the finished image with one glDrawPixels call. */
+
+#pragma once
+
+#include <GL/glut.h>
+#include "Framebuffer.h"
+
+class GLUTTarget : public RenderTarget {
+public:
+    // Draws the buffer at the window's lower-left corner regardless of the current projection
+    bool present(const Framebuffer& fb) override {
+        glPushAttrib(GL_ENABLE_BIT | GL_TRANSFORM_BIT);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_LIGHTING);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(0, fb.width, 0, fb.height, -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        glRasterPos2i(0, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, fb.stride);
+        glDrawPixels(fb.width, fb.height, GL_RGBA, GL_UNSIGNED_BYTE, fb.data());
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+        glPopMatrix();
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glPopAttrib();
+        return true;
+    }
+};
@@ -2,9 +2,13 @@
 Bezier) */
 
 #include <GL/glut.h>
+#include <chrono>
 #include <vector>
 #include <cmath>
+#include <cstring>
 #include <iostream>
+#include "CurveTessellator.h"
+#include "PolygonMesh.h"
 using namespace std;
 
 // ==========================
@@ -14,90 +18,174 @@ struct Vertex {
     float x, y, z;
 };
 
-vector<Vertex> vertices = {
-    {-0.5, -0.5, -0.5}, {0.5, -0.5, -0.5},
-    {0.5,  0.5, -0.5}, {-0.5,  0.5, -0.5},
-    {-0.5, -0.5,  0.5}, {0.5, -0.5,  0.5},
-    {0.5,  0.5,  0.5}, {-0.5,  0.5,  0.5}
-};
+// Unit cube by default, or the model named on the command line
+PolygonMesh cubeMesh;
+PolygonMesh importedMesh;
+MappedMesh mappedMesh;
+MeshView mesh;
 
-// Each face is a quad (indices to vertices)
-int faces[6][4] = {
-    {0, 1, 2, 3}, {4, 5, 6, 7},
-    {0, 1, 5, 4}, {2, 3, 7, 6},
-    {0, 3, 7, 4}, {1, 2, 6, 5}
-};
+void buildCube() {
+    float c[8][3] = {
+        {-0.5, -0.5, -0.5}, {0.5, -0.5, -0.5},
+        {0.5,  0.5, -0.5}, {-0.5,  0.5, -0.5},
+        {-0.5, -0.5,  0.5}, {0.5, -0.5,  0.5},
+        {0.5,  0.5,  0.5}, {-0.5,  0.5,  0.5}
+    };
+    cubeMesh.clear();
+    for (auto& v : c) cubeMesh.addVertex(v[0], v[1], v[2]);
+    cubeMesh.addFace({0, 3, 2, 1});
+    cubeMesh.addFace({4, 5, 6, 7});
+    cubeMesh.addFace({0, 1, 5, 4});
+    cubeMesh.addFace({2, 3, 7, 6});
+    cubeMesh.addFace({0, 4, 7, 3});
+    cubeMesh.addFace({1, 2, 6, 5});
+    cubeMesh.finalize();
+}
 
+// Function to open a model: .mesh files are mapped, .obj/.ply are imported. A model from the
+// command line can be anything, so its indices are checked before they reach glDrawElements.
+bool openModel(const string& path) {
+    if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".mesh") == 0) {
+        if (!mappedMesh.open(path, true)) return false;
+        mesh = mappedMesh.view();
+        return true;
+    }
+    if (!loadMesh(path, importedMesh)) return false;
+    mesh = importedMesh.view();
+    return true;
+}
+
+// Wireframe of the unique edges in one draw call, scaled to fit the cube's unit box
 void drawPolygonMesh() {
+    float size = 0;
+    for (int k = 0; k < 3; k++) size = max(size, mesh.boundsMax[k] - mesh.boundsMin[k]);
+    if (size <= 0) return;
+
+    glPushMatrix();
+    glScalef(1 / size, 1 / size, 1 / size);
+    glTranslatef(-(mesh.boundsMin[0] + mesh.boundsMax[0]) / 2, -(mesh.boundsMin[1] + mesh.boundsMax[1]) / 2,
+                 -(mesh.boundsMin[2] + mesh.boundsMax[2]) / 2);
     glColor3f(0.5, 0.8, 0.8);
-    for (int i = 0; i < 6; i++) {
-        glBegin(GL_LINE_LOOP);
-        for (int j = 0; j < 4; j++) {
-            Vertex v = vertices[faces[i][j]];
-            glVertex3f(v.x, v.y, v.z);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, mesh.positions);
+    glDrawElements(GL_LINES, (GLsizei)(mesh.edgeCount * 2), GL_UNSIGNED_INT, mesh.edges);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glPopMatrix();
+}
+
+// Function to build a grid of quads split into the given number of triangles
+void buildGrid(PolygonMesh& grid, size_t triangles) {
+    size_t n = max<size_t>(1, (size_t)sqrt(triangles / 2.0));
+    grid.clear();
+    for (size_t j = 0; j <= n; j++)
+        for (size_t i = 0; i <= n; i++)
+            grid.addVertex((float)i / n, (float)j / n, 0.1f * sin(i * 0.05f) * cos(j * 0.05f));
+    for (size_t j = 0; j < n; j++)
+        for (size_t i = 0; i < n; i++) {
+            uint32_t a = j * (n + 1) + i, b = a + 1, c = a + n + 2, d = a + n + 1;
+            grid.addFace({a, b, c});
+            grid.addFace({a, c, d});
         }
-        glEnd();
-    }
+    grid.finalize();
+}
+
+double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Function to compare OBJ parsing with mapping the binary file for the same model
+void benchmarkMesh(size_t triangles) {
+    PolygonMesh grid;
+    buildGrid(grid, triangles);
+    MeshView v = grid.view();
+    printf("%zu vertices, %zu triangles, %zu unique edges (%zu face sides)\n", v.vertexCount, v.triangleCount,
+           v.edgeCount, v.cornerCount());
+
+    const char* objPath = "/tmp/GeometricModel_bench.obj";
+    const char* meshPath = "/tmp/GeometricModel_bench.mesh";
+    FILE* f = fopen(objPath, "w");
+    if (!f) return;
+    for (size_t i = 0; i < v.vertexCount; i++)
+        fprintf(f, "v %g %g %g\n", v.positions[i * 3], v.positions[i * 3 + 1], v.positions[i * 3 + 2]);
+    for (size_t t = 0; t < v.triangleCount; t++)
+        fprintf(f, "f %u %u %u\n", v.triangles[t * 3] + 1, v.triangles[t * 3 + 1] + 1, v.triangles[t * 3 + 2] + 1);
+    fclose(f);
+    if (!writeMeshFile(v, meshPath)) return;
+
+    auto start = chrono::steady_clock::now();
+    PolygonMesh parsed;
+    bool ok = loadOBJ(objPath, parsed);
+    printf("%-34s %10.2f ms%s\n", "OBJ import (parse + edge list)", elapsedMs(start), ok ? "" : "  FAILED");
+
+    start = chrono::steady_clock::now();
+    MappedMesh mapped;
+    ok = mapped.open(meshPath);
+    MeshView m = mapped.view();
+    printf("%-34s %10.3f ms%s\n", "binary mmap open", elapsedMs(start), ok ? "" : "  FAILED");
+
+    // Touching every edge pulls the pages in; this is the cost the first draw pays
+    start = chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < m.edgeCount * 2; i++) sum += m.edges[i];
+    printf("%-34s %10.2f ms\n", "first pass over mapped edges", elapsedMs(start));
+
+    bool same = m.edgeCount == v.edgeCount && memcmp(m.edges, v.edges, v.edgeCount * 8) == 0 &&
+                parsed.edges == grid.edges;
+    printf("edge lists %s (checksum %llu)\n", same ? "match" : "DIFFER", (unsigned long long)sum);
+
+    // What openModel pays: the open plus one scan of every index, pages now cached
+    start = chrono::steady_clock::now();
+    MappedMesh verified;
+    ok = verified.open(meshPath, true);
+    printf("%-34s %10.2f ms%s\n", "binary mmap open + index check", elapsedMs(start), ok ? "" : "  FAILED");
+    remove(objPath);
+    remove(meshPath);
 }
 
 // ==========================
 // ==== HERMITE CURVE =======
 // ==========================
 
-Vertex hermite(float t, Vertex p0, Vertex p1, Vertex r0, Vertex r1) {
-    float h1 = 2*t*t*t - 3*t*t + 1;
-    float h2 = -2*t*t*t + 3*t*t;
-    float h3 = t*t*t - 2*t*t + t;
-    float h4 = t*t*t - t*t;
-    return {
-        h1*p0.x + h2*p1.x + h3*r0.x + h4*r1.x,
-        h1*p0.y + h2*p1.y + h3*r0.y + h4*r1.y,
-        0.0
-    };
-}
+// Curves are tessellated once into a vertex buffer and drawn with one call each
+CurveTessellator tessellator;
+vector<Vec2f> curveVertices;
+uint32_t curveStrips[3];
 
-void drawHermite() {
-    Vertex p0 = {-0.8, -0.2, 0}, p1 = {0.8, 0.2, 0};
+void buildCurves() {
+    Vertex hp0 = {-0.8, -0.2, 0}, hp1 = {0.8, 0.2, 0};
     Vertex r0 = {1, 1, 0}, r1 = {-1, 1, 0};
+    Vertex bp0 = {-0.9, -0.6, 0}, bp1 = {-0.3, 0.8, 0};
+    Vertex bp2 = {0.3, -0.8, 0}, bp3 = {0.9, 0.6, 0};
+
+    CurveBatch curves;
+    curves.addHermite(hp0, hp1, r0, r1);
+    curves.addBezier(bp0, bp1, bp2, bp3);
 
+    // About half a pixel at the default view
+    tessellator.tolerance = 0.002f;
+    curveVertices.resize(tessellator.tessellate(curves, nullptr, 0));
+    tessellator.tessellate(curves, curveVertices.data(), curveVertices.size(), curveStrips);
+}
+
+void drawCurve(int index) {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, curveVertices.data());
+    glDrawArrays(GL_LINE_STRIP, curveStrips[index], curveStrips[index + 1] - curveStrips[index]);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void drawHermite() {
     glColor3f(1, 0, 0);
-    glBegin(GL_LINE_STRIP);
-    for (float t = 0; t <= 1.0; t += 0.01) {
-        Vertex p = hermite(t, p0, p1, r0, r1);
-        glVertex3f(p.x, p.y, p.z);
-    }
-    glEnd();
+    drawCurve(0);
 }
 
 // ==========================
 // ==== BEZIER CURVE =========
 // ==========================
 
-Vertex bezier(float t, Vertex p0, Vertex p1, Vertex p2, Vertex p3) {
-    float u = 1 - t;
-    float b0 = u * u * u;
-    float b1 = 3 * u * u * t;
-    float b2 = 3 * u * t * t;
-    float b3 = t * t * t;
-
-    return {
-        b0*p0.x + b1*p1.x + b2*p2.x + b3*p3.x,
-        b0*p0.y + b1*p1.y + b2*p2.y + b3*p3.y,
-        0.0
-    };
-}
-
 void drawBezier() {
-    Vertex p0 = {-0.9, -0.6, 0}, p1 = {-0.3, 0.8, 0};
-    Vertex p2 = {0.3, -0.8, 0}, p3 = {0.9, 0.6, 0};
-
     glColor3f(0, 1, 0);
-    glBegin(GL_LINE_STRIP);
-    for (float t = 0; t <= 1.0; t += 0.01) {
-        Vertex p = bezier(t, p0, p1, p2, p3);
-        glVertex3f(p.x, p.y, p.z);
-    }
-    glEnd();
+    drawCurve(1);
 }
 
 // ==========================
@@ -118,6 +206,11 @@ void display() {
 }
 
 void init() {
+    buildCurves();
+    if (!mesh.positions) {
+        buildCube();
+        mesh = cubeMesh.view();
+    }
     glEnable(GL_DEPTH_TEST);
     glClearColor(0.1, 0.1, 0.1, 1);
     glMatrixMode(GL_PROJECTION);
@@ -130,7 +223,29 @@ void init() {
 // ==========================
 
 int main(int argc, char** argv) {
+    // "--convert <in.obj|in.ply> <out.mesh>", "--bench [triangles]", or a model to display
+    if (argc >= 4 && strcmp(argv[1], "--convert") == 0) {
+        PolygonMesh model;
+        if (!loadMesh(argv[2], model) || !writeMeshFile(model.view(), argv[3])) {
+            cerr << "Could not convert " << argv[2] << "\n";
+            return 1;
+        }
+        cout << model.vertexCount() << " vertices, " << model.faceCount() << " faces, "
+             << model.edges.size() / 2 << " unique edges\n";
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) {
+        benchmarkMesh(argc >= 3 ? strtoull(argv[2], nullptr, 10) : 1000000);
+        return 0;
+    }
+
+    // glutInit first so it strips its own options (-display, -geometry, ...) before the model path
     glutInit(&argc, argv);
+    if (argc >= 2 && !openModel(argv[1])) {
+        cerr << "Could not open " << argv[1] << "\n";
+        return 1;
+    }
+
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
     glutInitWindowSize(700, 700);
     glutCreateWindow("Geometric Modeling: Mesh, Hermite, Bezier - PhD Code");
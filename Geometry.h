@@ -0,0 +1,16 @@
+/* Geometry: small value types shared by the headless algorithm headers. */
+
+#pragma once
+
+struct Vec2f {
+    float x, y;
+};
+
+inline Vec2f operator+(Vec2f a, Vec2f b) { return {a.x + b.x, a.y + b.y}; }
+inline Vec2f operator-(Vec2f a, Vec2f b) { return {a.x - b.x, a.y - b.y}; }
+inline Vec2f operator*(float s, Vec2f a) { return {s * a.x, s * a.y}; }
+
+// z component of (b - a) x (c - a); positive when a, b, c turn counter-clockwise
+inline float cross(Vec2f a, Vec2f b, Vec2f c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
@@ -3,6 +3,10 @@
 #include <GL/glut.h>
 #include <iostream>
 #include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include "CurveTessellator.h"
 
 using namespace std;
 
@@ -19,9 +23,8 @@ Point p3 = {350.0f, 100.0f}; // Control point 4
 Point tangent1 = {100.0f, 0.0f};  // Tangent vector at p0
 Point tangent2 = {-100.0f, 0.0f}; // Tangent vector at p3
 
-// Function to calculate Hermite curve
-void hermiteCurve(Point p0, Point p1, Point tangent1, Point tangent2, int segments) {
-    glBegin(GL_LINE_STRIP);
+// Function to calculate Hermite curve at a fixed step; kept as the reference for --bench
+int hermiteCurve(Point p0, Point p1, Point tangent1, Point tangent2, int segments, Point* out) {
     for (int i = 0; i <= segments; i++) {
         float t = (float)i / (float)segments;
         float h0 = 2 * t * t * t - 3 * t * t + 1;
@@ -32,14 +35,13 @@ void hermiteCurve(Point p0, Point p1, Point tangent1, Point tangent2, int segmen
         float x = h0 * p0.x + h1 * p1.x + h2 * tangent1.x + h3 * tangent2.x;
         float y = h0 * p0.y + h1 * p1.y + h2 * tangent1.y + h3 * tangent2.y;
 
-        glVertex2f(x, y);
+        out[i] = {x, y};
     }
-    glEnd();
+    return segments + 1;
 }
 
-// Function to calculate Bezier curve
-void bezierCurve(Point p0, Point p1, Point p2, Point p3, int segments) {
-    glBegin(GL_LINE_STRIP);
+// Function to calculate Bezier curve at a fixed step; kept as the reference for --bench
+int bezierCurve(Point p0, Point p1, Point p2, Point p3, int segments, Point* out) {
     for (int i = 0; i <= segments; i++) {
         float t = (float)i / (float)segments;
         float x = (1 - t) * (1 - t) * (1 - t) * p0.x + 
@@ -52,35 +54,113 @@ void bezierCurve(Point p0, Point p1, Point p2, Point p3, int segments) {
                   3 * t * t * (1 - t) * p2.y + 
                   t * t * t * p3.y;
 
-        glVertex2f(x, y);
+        out[i] = {x, y};
     }
-    glEnd();
+    return segments + 1;
 }
 
+// Both curves tessellated to within a quarter pixel
+CurveBatch curves;
+CurveTessellator tessellator;
+vector<Vec2f> curveVertices;
+uint32_t curveStrips[3];
+
 // Function to display the curves
 void display() {
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // Set color for Hermite curve (Red)
-    glColor3f(1.0f, 0.0f, 0.0f);
-    hermiteCurve(p0, p3, tangent1, tangent2, 100);  // Draw Hermite curve
-
-    // Set color for Bezier curve (Green)
-    glColor3f(0.0f, 1.0f, 0.0f);
-    bezierCurve(p0, p1, p2, p3, 100);  // Draw Bezier curve
+    // Hermite curve (Red), then Bezier curve (Green), each drawn from the vertex buffer
+    const GLfloat colors[2][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, curveVertices.data());
+    for (int i = 0; i < 2; i++) {
+        glColor3fv(colors[i]);
+        glDrawArrays(GL_LINE_STRIP, curveStrips[i], curveStrips[i + 1] - curveStrips[i]);
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
 
     glFlush();
     glutSwapBuffers();
 }
 
+// Throughput of the fixed-step evaluators against the tessellator on random curves
+int benchmarkCurves() {
+    const int count = 200000;
+    mt19937 rng(7);
+    uniform_real_distribution<float> coord(0, 4000), tangent(-2000, 2000);
+
+    // Each Hermite curve runs from c[0] to c[3] with tangents r[0] and r[1]; the reference
+    // and the tessellator are fed the same ones so both measure the same curves
+    vector<Point> control(count * 4), tangents(count * 2);
+    for (auto& p : control) p = {coord(rng), coord(rng)};
+    for (auto& r : tangents) r = {tangent(rng), tangent(rng)};
+    CurveBatch hermites, beziers;
+    for (int i = 0; i < count; i++) {
+        Point *c = &control[i * 4], *r = &tangents[i * 2];
+        hermites.addHermite(c[0], c[3], r[0], r[1]);
+        beziers.addBezier(c[0], c[1], c[2], c[3]);
+    }
+
+    auto report = [](const char* name, size_t vertices, double ms) {
+        printf("%-34s %10zu vertices %9.2f ms %8.1f M vertices/s\n", name, vertices, ms, vertices / (ms * 1e3));
+    };
+    auto elapsedMs = [](chrono::steady_clock::time_point t0) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    };
+
+    vector<Point> fixed(101);
+    auto t0 = chrono::steady_clock::now();
+    size_t total = 0;
+    volatile float sink = 0;
+    for (int i = 0; i < count; i++) {
+        Point* c = &control[i * 4];
+        total += bezierCurve(c[0], c[1], c[2], c[3], 100, fixed.data());
+        sink = sink + fixed[50].x;
+    }
+    report("bezierCurve (100 segments)", total, elapsedMs(t0));
+
+    t0 = chrono::steady_clock::now();
+    total = 0;
+    for (int i = 0; i < count; i++) {
+        Point *c = &control[i * 4], *r = &tangents[i * 2];
+        total += hermiteCurve(c[0], c[3], r[0], r[1], 100, fixed.data());
+        sink = sink + fixed[50].x;
+    }
+    report("hermiteCurve (100 segments)", total, elapsedMs(t0));
+
+    CurveTessellator tess;
+    vector<Vec2f> out;
+    const char* names[2] = {"adaptive (0.25 px)", "forward differencing (0.25 px)"};
+    for (int mode = 0; mode < 2; mode++) {
+        tess.mode = (TessellationMode)mode;
+        for (CurveBatch* batch : {&beziers, &hermites}) {
+            out.resize(tess.tessellate(*batch, nullptr, 0));
+            t0 = chrono::steady_clock::now();
+            total = tess.tessellate(*batch, out.data(), out.size());
+            string name = string(batch == &beziers ? "bezier " : "hermite ") + names[mode];
+            report(name.c_str(), total, elapsedMs(t0));
+        }
+    }
+    return 0;
+}
+
 // Function to set up OpenGL environment
 void init() {
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);  // Set background color to white
     gluOrtho2D(0.0f, 400.0f, 0.0f, 400.0f); // Define 2D orthogonal projection
+
+    curves.addHermite(p0, p3, tangent1, tangent2);
+    curves.addBezier(p0, p1, p2, p3);
+    curveVertices.resize(tessellator.tessellate(curves, nullptr, 0));
+    tessellator.tessellate(curves, curveVertices.data(), curveVertices.size(), curveStrips);
 }
 
 // Main function to initialize and start the program
 int main(int argc, char** argv) {
+    // "--bench" measures tessellation throughput without opening a window
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return benchmarkCurves();
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(400, 400);
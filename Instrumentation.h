@@ -0,0 +1,99 @@
+/* Scoped timers and counters for the algorithm hot paths.
+Probes are compiled in only when GRAPHICS_INSTRUMENTATION is defined (the CMake option of the
+same name); otherwise both macros expand to nothing and cost nothing.
+
+  GRAPHICS_TIMED_SCOPE("scanline.fill");     calls and total time until the end of the scope
+  GRAPHICS_COUNT("scanline.spans", spans);   adds to a named counter
+
+Every probe site registers itself the first time it runs; reportProbes prints one line per
+site. Updates are relaxed atomics, so probes may fire from several threads. Sites that share
+a name are reported separately. */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#if defined(GRAPHICS_INSTRUMENTATION)
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+struct ProbeSite {
+    const char* name;
+    std::atomic<uint64_t> calls{0}, nanoseconds{0}, count{0};
+    ProbeSite* next = nullptr;
+
+    explicit ProbeSite(const char* name) : name(name) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        next = head();
+        head() = this;
+    }
+
+    static ProbeSite*& head() {
+        static ProbeSite* first = nullptr;
+        return first;
+    }
+
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+};
+
+class ScopedProbeTimer {
+public:
+    explicit ScopedProbeTimer(ProbeSite& site) : site(site), start(std::chrono::steady_clock::now()) {}
+    ~ScopedProbeTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        site.calls.fetch_add(1, std::memory_order_relaxed);
+        site.nanoseconds.fetch_add((uint64_t)ns.count(), std::memory_order_relaxed);
+    }
+
+private:
+    ProbeSite& site;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define GRAPHICS_PROBE_JOIN2(a, b) a##b
+#define GRAPHICS_PROBE_JOIN(a, b) GRAPHICS_PROBE_JOIN2(a, b)
+#define GRAPHICS_TIMED_SCOPE(name)                                                   \
+    static ProbeSite GRAPHICS_PROBE_JOIN(probeSite_, __LINE__)(name);                \
+    ScopedProbeTimer GRAPHICS_PROBE_JOIN(probeTimer_, __LINE__)(GRAPHICS_PROBE_JOIN(probeSite_, __LINE__))
+#define GRAPHICS_COUNT(name, n)                                                      \
+    do {                                                                             \
+        static ProbeSite probeSite(name);                                            \
+        probeSite.count.fetch_add((uint64_t)(n), std::memory_order_relaxed);         \
+    } while (0)
+
+inline constexpr bool instrumentationEnabled() { return true; }
+
+inline void reportProbes(FILE* out = stdout) {
+    std::lock_guard<std::mutex> lock(ProbeSite::registryMutex());
+    std::fprintf(out, "%-28s %12s %14s %12s %16s\n", "probe", "calls", "total ms", "ns/call", "count");
+    for (ProbeSite* s = ProbeSite::head(); s; s = s->next) {
+        uint64_t calls = s->calls, ns = s->nanoseconds, count = s->count;
+        if (calls)
+            std::fprintf(out, "%-28s %12llu %14.3f %12.1f %16llu\n", s->name, (unsigned long long)calls, ns / 1e6,
+                         (double)ns / calls, (unsigned long long)count);
+        else
+            std::fprintf(out, "%-28s %12s %14s %12s %16llu\n", s->name, "-", "-", "-", (unsigned long long)count);
+    }
+}
+
+inline void resetProbes() {
+    std::lock_guard<std::mutex> lock(ProbeSite::registryMutex());
+    for (ProbeSite* s = ProbeSite::head(); s; s = s->next) s->calls = s->nanoseconds = s->count = 0;
+}
+
+#else
+
+#define GRAPHICS_TIMED_SCOPE(name) ((void)0)
+#define GRAPHICS_COUNT(name, n) ((void)sizeof(n))
+
+inline constexpr bool instrumentationEnabled() { return false; }
+inline void reportProbes(FILE* = stdout) {}
+inline void resetProbes() {}
+
+#endif
@@ -0,0 +1,212 @@
+/* Batched Cohen-Sutherland line clipping.
+Segments are stored as a structure of arrays and clipped in place against a runtime window.
+Outcodes are computed for 8 (AVX2) or 4 (SSE2) segments at a time so whole lanes can be
+trivially accepted or rejected; only segments that straddle the window boundary go through
+the float intersection path. Builds without SSE2 use the scalar loop. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Instrumentation.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Clipping window, given at run time
+struct ClipWindow {
+    float xmin, ymin, xmax, ymax;
+};
+
+// Segments (x0, y0) -> (x1, y1) as a structure of arrays
+struct SegmentBatch {
+    std::vector<float> x0, y0, x1, y1;
+
+    size_t size() const { return x0.size(); }
+
+    void resize(size_t n) {
+        x0.resize(n); y0.resize(n); x1.resize(n); y1.resize(n);
+    }
+
+    void push_back(float ax, float ay, float bx, float by) {
+        x0.push_back(ax); y0.push_back(ay); x1.push_back(bx); y1.push_back(by);
+    }
+};
+
+// Per-segment result written by clipSegments
+enum SegmentClipStatus : uint8_t {
+    SEGMENT_REJECTED = 0,  // entirely outside the window
+    SEGMENT_INSIDE = 1,    // entirely inside, endpoints unchanged
+    SEGMENT_CLIPPED = 2    // endpoints moved onto the window boundary
+};
+
+// Outcode bits, same layout as the single-line programs
+const int CLIP_LEFT = 1, CLIP_RIGHT = 2, CLIP_BOTTOM = 4, CLIP_TOP = 8;
+
+inline int segmentOutcode(float x, float y, const ClipWindow& w) {
+    return (x < w.xmin) * CLIP_LEFT | (x > w.xmax) * CLIP_RIGHT |
+           (y < w.ymin) * CLIP_BOTTOM | (y > w.ymax) * CLIP_TOP;
+}
+
+// Cohen-Sutherland on one segment in floating point. Returns false if nothing is visible.
+// Each end point is clipped against an edge at most once: near a corner float rounding can put
+// the new point a hair outside the edge it was last clipped to, and recomputing that bit would
+// bounce between two edges forever.
+inline bool clipSegment(float& x0, float& y0, float& x1, float& y1, const ClipWindow& w) {
+    int out0 = segmentOutcode(x0, y0, w);
+    int out1 = segmentOutcode(x1, y1, w);
+    int done0 = 0, done1 = 0;  // edges each end point has already been clipped to
+
+    while (true) {
+        if (!(out0 | out1)) return true;
+        if (out0 & out1) return false;
+
+        int outcode = out0 ? out0 : out1;
+        int edge;
+        float x, y;
+        if (outcode & CLIP_TOP) {
+            x = x0 + (x1 - x0) * (w.ymax - y0) / (y1 - y0);
+            y = w.ymax;
+            edge = CLIP_TOP;
+        } else if (outcode & CLIP_BOTTOM) {
+            x = x0 + (x1 - x0) * (w.ymin - y0) / (y1 - y0);
+            y = w.ymin;
+            edge = CLIP_BOTTOM;
+        } else if (outcode & CLIP_RIGHT) {
+            y = y0 + (y1 - y0) * (w.xmax - x0) / (x1 - x0);
+            x = w.xmax;
+            edge = CLIP_RIGHT;
+        } else {
+            y = y0 + (y1 - y0) * (w.xmin - x0) / (x1 - x0);
+            x = w.xmin;
+            edge = CLIP_LEFT;
+        }
+
+        if (outcode == out0) {
+            x0 = x; y0 = y;
+            done0 |= edge;
+            out0 = segmentOutcode(x0, y0, w) & ~done0;
+        } else {
+            x1 = x; y1 = y;
+            done1 |= edge;
+            out1 = segmentOutcode(x1, y1, w) & ~done1;
+        }
+    }
+}
+
+// Clips segments [begin, end) one at a time
+inline size_t clipSegmentsScalar(SegmentBatch& s, const ClipWindow& w, uint8_t* status,
+                                 size_t begin, size_t end) {
+    size_t visible = 0;
+    for (size_t i = begin; i < end; i++) {
+        int out0 = segmentOutcode(s.x0[i], s.y0[i], w);
+        int out1 = segmentOutcode(s.x1[i], s.y1[i], w);
+        if (!(out0 | out1)) {
+            status[i] = SEGMENT_INSIDE;
+        } else if (out0 & out1) {
+            status[i] = SEGMENT_REJECTED;
+        } else {
+            bool ok = clipSegment(s.x0[i], s.y0[i], s.x1[i], s.y1[i], w);
+            status[i] = ok ? SEGMENT_CLIPPED : SEGMENT_REJECTED;
+        }
+        visible += status[i] != SEGMENT_REJECTED;
+    }
+    return visible;
+}
+
+// Handles lanes that were neither trivially accepted nor rejected
+inline size_t clipStraddlingLanes(SegmentBatch& s, const ClipWindow& w, uint8_t* status,
+                                  size_t base, int lanes, int acceptMask, int rejectMask) {
+    size_t visible = 0;
+    for (int lane = 0; lane < lanes; lane++) {
+        size_t i = base + lane;
+        if (acceptMask >> lane & 1) {
+            status[i] = SEGMENT_INSIDE;
+            visible++;
+        } else if (rejectMask >> lane & 1) {
+            status[i] = SEGMENT_REJECTED;
+        } else {
+            bool ok = clipSegment(s.x0[i], s.y0[i], s.x1[i], s.y1[i], w);
+            status[i] = ok ? SEGMENT_CLIPPED : SEGMENT_REJECTED;
+            visible += ok;
+        }
+    }
+    return visible;
+}
+
+#if defined(__AVX2__)
+
+inline __m256i outcode8(__m256 x, __m256 y, __m256 xmin, __m256 ymin, __m256 xmax, __m256 ymax) {
+    __m256i left = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(x, xmin, _CMP_LT_OQ)), _mm256_set1_epi32(CLIP_LEFT));
+    __m256i right = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(x, xmax, _CMP_GT_OQ)), _mm256_set1_epi32(CLIP_RIGHT));
+    __m256i bottom = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(y, ymin, _CMP_LT_OQ)), _mm256_set1_epi32(CLIP_BOTTOM));
+    __m256i top = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(y, ymax, _CMP_GT_OQ)), _mm256_set1_epi32(CLIP_TOP));
+    return _mm256_or_si256(_mm256_or_si256(left, right), _mm256_or_si256(bottom, top));
+}
+
+#elif defined(__SSE2__)
+
+inline __m128i outcode4(__m128 x, __m128 y, __m128 xmin, __m128 ymin, __m128 xmax, __m128 ymax) {
+    __m128i left = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(x, xmin)), _mm_set1_epi32(CLIP_LEFT));
+    __m128i right = _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(x, xmax)), _mm_set1_epi32(CLIP_RIGHT));
+    __m128i bottom = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(y, ymin)), _mm_set1_epi32(CLIP_BOTTOM));
+    __m128i top = _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(y, ymax)), _mm_set1_epi32(CLIP_TOP));
+    return _mm_or_si128(_mm_or_si128(left, right), _mm_or_si128(bottom, top));
+}
+
+#endif
+
+// Clips every segment in place and fills status[i]; returns the number of visible segments
+inline size_t clipSegments(SegmentBatch& s, const ClipWindow& w, uint8_t* status) {
+    GRAPHICS_TIMED_SCOPE("line_clip.batch");
+    size_t n = s.size();
+    GRAPHICS_COUNT("line_clip.segments", n);
+    size_t i = 0;
+    size_t visible = 0;
+
+#if defined(__AVX2__)
+    const __m256 xmin = _mm256_set1_ps(w.xmin), ymin = _mm256_set1_ps(w.ymin);
+    const __m256 xmax = _mm256_set1_ps(w.xmax), ymax = _mm256_set1_ps(w.ymax);
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256i c0 = outcode8(_mm256_loadu_ps(&s.x0[i]), _mm256_loadu_ps(&s.y0[i]), xmin, ymin, xmax, ymax);
+        __m256i c1 = outcode8(_mm256_loadu_ps(&s.x1[i]), _mm256_loadu_ps(&s.y1[i]), xmin, ymin, xmax, ymax);
+        int accept = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_or_si256(c0, c1), zero)));
+        int keep = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(c0, c1), zero)));
+        int reject = ~keep & 0xFF;
+        if (accept == 0xFF) {
+            std::memset(status + i, SEGMENT_INSIDE, 8);
+            visible += 8;
+        } else if (reject == 0xFF) {
+            std::memset(status + i, SEGMENT_REJECTED, 8);
+        } else {
+            visible += clipStraddlingLanes(s, w, status, i, 8, accept, reject);
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128 xmin = _mm_set1_ps(w.xmin), ymin = _mm_set1_ps(w.ymin);
+    const __m128 xmax = _mm_set1_ps(w.xmax), ymax = _mm_set1_ps(w.ymax);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4) {
+        __m128i c0 = outcode4(_mm_loadu_ps(&s.x0[i]), _mm_loadu_ps(&s.y0[i]), xmin, ymin, xmax, ymax);
+        __m128i c1 = outcode4(_mm_loadu_ps(&s.x1[i]), _mm_loadu_ps(&s.y1[i]), xmin, ymin, xmax, ymax);
+        int accept = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_or_si128(c0, c1), zero)));
+        int keep = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(c0, c1), zero)));
+        int reject = ~keep & 0xF;
+        if (accept == 0xF) {
+            std::memset(status + i, SEGMENT_INSIDE, 4);
+            visible += 4;
+        } else if (reject == 0xF) {
+            std::memset(status + i, SEGMENT_REJECTED, 4);
+        } else {
+            visible += clipStraddlingLanes(s, w, status, i, 4, accept, reject);
+        }
+    }
+#endif
+
+    return visible + clipSegmentsScalar(s, w, status, i, n);
+}
@@ -0,0 +1,413 @@
+/* Offline animation renderer: renders a frame range without a window.
+Each frame's parameters (rotation angle, scale, projection) come from a schedule given on the
+command line. Frames are rendered as tasks on a work-stealing ThreadPool into a fixed set of
+reusable framebuffers, and an encoder thread writes finished frames in order (PPM sequence or
+one raw Y4M stream) while later frames are still rendering. A framebuffer is handed out again
+only once its frame has been written, so the pipeline runs in bounded memory. Per-frame
+timings can be written to a CSV file.
+
+Options (after --offline):
+  --frames A:B         frames A to B inclusive (default 0:119)
+  --angle S:E          angle in degrees, linear from S at frame A to E at frame B (0:360)
+  --scale S:E          uniform scale, linear the same way (1:1)
+  --projection P       perspective, parallel, or toggle=N to switch every N frames
+  --size WxH           frame size (640x480)
+  --output PATH        *.y4m for a Y4M stream, otherwise a PPM pattern such as frames/%05d.ppm
+                       (one %d or %0Nd for the frame number, %% for a literal %)
+  --fps N              Y4M frame rate (30)
+  --threads N          render threads (0: one per core); the caller only schedules frames
+  --buffers N          framebuffers in flight, at least 1 (default: two per render thread plus one)
+  --csv PATH           per-frame timing */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Framebuffer.h"
+#include "ThreadPool.h"
+
+// ==== Schedule ====
+
+struct FrameParams {
+    int frame;
+    float angle;  // degrees
+    float scale;
+    bool perspective;
+};
+
+struct FrameSchedule {
+    int first = 0, last = 119;
+    float angleStart = 0, angleEnd = 360;
+    float scaleStart = 1, scaleEnd = 1;
+    bool perspective = true;
+    int projectionPeriod = 0;  // > 0 switches projection every projectionPeriod frames
+
+    size_t count() const { return last >= first ? (size_t)(last - first + 1) : 0; }
+
+    FrameParams at(int frame) const {
+        float t = last > first ? (float)(frame - first) / (last - first) : 0;
+        bool p = perspective;
+        if (projectionPeriod > 0 && ((frame - first) / projectionPeriod) % 2) p = !p;
+        return {frame, angleStart + (angleEnd - angleStart) * t, scaleStart + (scaleEnd - scaleStart) * t, p};
+    }
+};
+
+struct OfflineOptions {
+    FrameSchedule schedule;
+    int width = 640, height = 480;
+    std::string output = "frame_%05d.ppm";
+    std::string csv;
+    int fps = 30;
+    unsigned threads = 0;  // render threads, 0 for one per core
+    int buffers = 0;       // 0 for two per render thread plus one
+};
+
+// Output path with one frame-number field: %d or %0Nd, plus %% for a literal percent sign.
+// The path is built by hand rather than passing user input to printf as a format string.
+struct FramePattern {
+    std::string prefix, suffix;
+    int digits = 0;  // zero-padded width, 0 for none
+
+    bool parse(const std::string& pattern) {
+        prefix.clear();
+        suffix.clear();
+        digits = 0;
+        bool field = false;
+        for (size_t i = 0; i < pattern.size(); i++) {
+            std::string& out = field ? suffix : prefix;
+            if (pattern[i] != '%') {
+                out += pattern[i];
+                continue;
+            }
+            if (++i < pattern.size() && pattern[i] == '%') {
+                out += '%';
+                continue;
+            }
+            if (field) return false;
+            if (i < pattern.size() && pattern[i] == '0') {
+                for (i++; i < pattern.size() && std::isdigit((unsigned char)pattern[i]); i++)
+                    digits = digits * 10 + (pattern[i] - '0');
+                if (digits > 32) return false;
+            }
+            if (i >= pattern.size() || pattern[i] != 'd') return false;
+            field = true;
+        }
+        return field;
+    }
+
+    std::string path(int frame) const {
+        std::string number = std::to_string(frame < 0 ? -(long long)frame : (long long)frame);
+        size_t width = (size_t)std::max(digits - (frame < 0), 0);
+        if (number.size() < width) number.insert(0, width - number.size(), '0');
+        return prefix + (frame < 0 ? "-" : "") + number + suffix;
+    }
+};
+
+inline bool isY4MPath(const std::string& path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+}
+
+// A PPM path without a frame-number field gets one before its extension
+inline std::string sequencePattern(std::string path) {
+    if (path.find('%') == std::string::npos) {
+        size_t dot = path.rfind('.');
+        if (dot == std::string::npos || path.find('/', dot) != std::string::npos) dot = path.size();
+        path.insert(dot, "_%05d");
+    }
+    return path;
+}
+
+// Whole decimal number in [min, max]; rejects empty input, trailing text and overflow
+inline bool parseIntOption(const char* value, long min, long max, long& out) {
+    char* end;
+    errno = 0;
+    out = std::strtol(value, &end, 10);
+    return end != value && *end == 0 && errno == 0 && out >= min && out <= max;
+}
+
+inline bool offlineRequested(int argc, char** argv) {
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--offline") == 0) return true;
+    return false;
+}
+
+// Reads the options that follow --offline; returns false with a message on a bad option
+inline bool parseOfflineOptions(int argc, char** argv, OfflineOptions& options, std::string& error) {
+    FrameSchedule& s = options.schedule;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--offline") continue;
+        if (i + 1 >= argc) {
+            error = "missing value for " + arg;
+            return false;
+        }
+        const char* value = argv[++i];
+        bool ok = true;
+        if (arg == "--frames") ok = std::sscanf(value, "%d:%d", &s.first, &s.last) == 2 && s.first <= s.last;
+        else if (arg == "--angle") ok = std::sscanf(value, "%f:%f", &s.angleStart, &s.angleEnd) == 2;
+        else if (arg == "--scale") ok = std::sscanf(value, "%f:%f", &s.scaleStart, &s.scaleEnd) == 2;
+        else if (arg == "--projection") {
+            std::string p = value;
+            s.projectionPeriod = 0;
+            if (p == "perspective") s.perspective = true;
+            else if (p == "parallel") s.perspective = false;
+            else ok = std::sscanf(value, "toggle=%d", &s.projectionPeriod) == 1 && s.projectionPeriod > 0;
+        } else if (arg == "--size") {
+            ok = std::sscanf(value, "%dx%d", &options.width, &options.height) == 2 && options.width > 0 &&
+                 options.height > 0;
+        } else if (arg == "--output") {
+            options.output = value;
+            FramePattern pattern;
+            ok = isY4MPath(options.output) || pattern.parse(sequencePattern(options.output));
+        } else if (arg == "--csv") options.csv = value;
+        else if (arg == "--fps" || arg == "--threads" || arg == "--buffers") {
+            long n;
+            if (arg == "--fps" && (ok = parseIntOption(value, 1, 1000, n))) options.fps = (int)n;
+            if (arg == "--threads" && (ok = parseIntOption(value, 0, 1024, n))) options.threads = (unsigned)n;
+            if (arg == "--buffers" && (ok = parseIntOption(value, 1, 1024, n))) options.buffers = (int)n;
+        } else {
+            error = "unknown option " + arg;
+            return false;
+        }
+        if (!ok) {
+            error = "bad value for " + arg + ": " + value;
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==== Encoders ====
+
+class FrameEncoder {
+public:
+    virtual ~FrameEncoder() = default;
+    // Called once before rendering starts, so a bad output path fails before any work is done
+    virtual bool open(int width, int height, int fps, int firstFrame) = 0;
+    virtual bool write(const Framebuffer& fb, int frame) = 0;
+    virtual bool close() { return true; }
+};
+
+// One PPM file per frame, named by a FramePattern
+class PPMSequenceEncoder : public FrameEncoder {
+public:
+    explicit PPMSequenceEncoder(std::string pattern) : pattern(std::move(pattern)) {}
+
+    // Creates the first frame's file up front (its write replaces it), so a missing directory
+    // or an unwritable path is reported before anything is rendered
+    bool open(int, int, int, int firstFrame) override {
+        if (!names.parse(pattern)) return false;
+        FILE* f = std::fopen(names.path(firstFrame).c_str(), "wb");
+        return f && std::fclose(f) == 0;
+    }
+
+    bool write(const Framebuffer& fb, int frame) override { return writePPM(fb, names.path(frame)); }
+
+private:
+    std::string pattern;
+    FramePattern names;
+};
+
+// Uncompressed YUV4MPEG2 stream, 4:2:0 with full-range BT.601 color, top row first. The
+// range is tagged in the header; without XCOLORRANGE=FULL players assume limited range.
+class Y4MEncoder : public FrameEncoder {
+public:
+    explicit Y4MEncoder(std::string path) : path(std::move(path)) {}
+    ~Y4MEncoder() override { close(); }
+
+    bool open(int width, int height, int fps, int) override {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, fps);
+        int cw = (width + 1) / 2, ch = (height + 1) / 2;
+        planes.resize((size_t)width * height + 2 * (size_t)cw * ch);
+        return true;
+    }
+
+    bool write(const Framebuffer& fb, int) override {
+        int w = fb.width, h = fb.height, cw = (w + 1) / 2, ch = (h + 1) / 2;
+        uint8_t* yPlane = planes.data();
+        uint8_t* uPlane = yPlane + (size_t)w * h;
+        uint8_t* vPlane = uPlane + (size_t)cw * ch;
+        for (int y = 0; y < h; y++) {
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(fb.row(h - 1 - y));
+            for (int x = 0; x < w; x++)
+                yPlane[(size_t)y * w + x] = luma(src[x * 4], src[x * 4 + 1], src[x * 4 + 2]);
+        }
+        // Chroma from the average of each 2x2 block
+        for (int cy = 0; cy < ch; cy++) {
+            for (int cx = 0; cx < cw; cx++) {
+                int r = 0, g = 0, b = 0, n = 0;
+                for (int dy = 0; dy < 2 && cy * 2 + dy < h; dy++) {
+                    const uint8_t* src = reinterpret_cast<const uint8_t*>(fb.row(h - 1 - (cy * 2 + dy)));
+                    for (int dx = 0; dx < 2 && cx * 2 + dx < w; dx++, n++) {
+                        const uint8_t* p = src + (cx * 2 + dx) * 4;
+                        r += p[0]; g += p[1]; b += p[2];
+                    }
+                }
+                float rf = (float)r / n, gf = (float)g / n, bf = (float)b / n;
+                uPlane[(size_t)cy * cw + cx] = clampByte(128 - 0.168736f * rf - 0.331264f * gf + 0.5f * bf);
+                vPlane[(size_t)cy * cw + cx] = clampByte(128 + 0.5f * rf - 0.418688f * gf - 0.081312f * bf);
+            }
+        }
+        return std::fputs("FRAME\n", file) >= 0 && std::fwrite(planes.data(), 1, planes.size(), file) == planes.size();
+    }
+
+    bool close() override {
+        if (!file) return true;
+        bool ok = std::fclose(file) == 0;
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    static uint8_t clampByte(float v) { return (uint8_t)std::min(std::max(v + 0.5f, 0.0f), 255.0f); }
+    static uint8_t luma(int r, int g, int b) { return clampByte(0.299f * r + 0.587f * g + 0.114f * b); }
+
+    std::string path;
+    FILE* file = nullptr;
+    std::vector<uint8_t> planes;
+};
+
+// Pick an encoder from the output path: .y4m, anything else is a PPM sequence
+inline std::unique_ptr<FrameEncoder> makeFrameEncoder(const std::string& path) {
+    if (isY4MPath(path)) return std::unique_ptr<FrameEncoder>(new Y4MEncoder(path));
+    return std::unique_ptr<FrameEncoder>(new PPMSequenceEncoder(sequencePattern(path)));
+}
+
+// ==== Pipeline ====
+
+struct FrameTiming {
+    FrameParams params;
+    double waitMs = 0;     // waiting for a free framebuffer
+    double renderMs = 0;
+    double encodeMs = 0;
+    double latencyMs = 0;  // from submission until the frame was written
+};
+
+// Renders every frame of the schedule with renderFrame, which must be safe to call from
+// several threads at once. Returns a process exit code.
+inline int renderOffline(const OfflineOptions& options,
+                         const std::function<void(const FrameParams&, Framebuffer&)>& renderFrame) {
+    typedef std::chrono::steady_clock Clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    const FrameSchedule& schedule = options.schedule;
+    size_t count = schedule.count();
+    std::unique_ptr<FrameEncoder> encoder = makeFrameEncoder(options.output);
+    if (!encoder->open(options.width, options.height, options.fps, schedule.first)) {
+        std::fprintf(stderr, "Could not open %s\n", options.output.c_str());
+        return 1;
+    }
+
+    // The calling thread only schedules and waits, so the pool gets one thread more than the
+    // number that render: ThreadPool counts the caller but submit runs tasks on its workers
+    unsigned renderThreads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(renderThreads + 1);
+    size_t bufferCount = options.buffers > 0 ? options.buffers : 2 * renderThreads + 1;
+    std::vector<Framebuffer> buffers(bufferCount);
+    for (auto& fb : buffers) fb.resize(options.width, options.height);
+
+    std::vector<FrameTiming> timings(count);
+    std::vector<Clock::time_point> submitted(count);
+    std::mutex mutex;
+    std::condition_variable bufferFree, frameReady;
+    std::vector<size_t> freeBuffers;
+    for (size_t i = bufferCount; i-- > 0;) freeBuffers.push_back(i);
+    std::vector<int> readyBuffer(count, -1);
+    bool encodeFailed = false;
+
+    auto start = Clock::now();
+
+    // Writes frames strictly in order, handing each buffer back as soon as it is written
+    std::thread encodeThread([&] {
+        for (size_t f = 0; f < count; f++) {
+            size_t slot;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                frameReady.wait(lock, [&] { return readyBuffer[f] >= 0; });
+                slot = readyBuffer[f];
+            }
+            auto t0 = Clock::now();
+            bool ok = encoder->write(buffers[slot], schedule.first + (int)f);
+            auto t1 = Clock::now();
+            timings[f].encodeMs = ms(t0, t1);
+            timings[f].latencyMs = ms(submitted[f], t1);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                encodeFailed = encodeFailed || !ok;
+                freeBuffers.push_back(slot);
+            }
+            bufferFree.notify_one();
+        }
+    });
+
+    // Buffers are taken in frame order, so the oldest unwritten frame always has one
+    for (size_t f = 0; f < count; f++) {
+        auto t0 = Clock::now();
+        size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            bufferFree.wait(lock, [&] { return !freeBuffers.empty(); });
+            slot = freeBuffers.back();
+            freeBuffers.pop_back();
+        }
+        submitted[f] = Clock::now();
+        timings[f].params = schedule.at(schedule.first + (int)f);
+        timings[f].waitMs = ms(t0, submitted[f]);
+        pool.submit([&, f, slot] {
+            auto r0 = Clock::now();
+            renderFrame(timings[f].params, buffers[slot]);
+            timings[f].renderMs = ms(r0, Clock::now());
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                readyBuffer[f] = (int)slot;
+            }
+            frameReady.notify_one();
+        });
+    }
+    pool.wait();
+    encodeThread.join();
+    bool ok = encoder->close() && !encodeFailed;
+    double totalMs = ms(start, Clock::now());
+
+    double render = 0, encode = 0;
+    for (auto& t : timings) {
+        render += t.renderMs;
+        encode += t.encodeMs;
+    }
+    std::printf("%zu frames in %.1f ms (%.1f frames/s), %u render threads, %zu buffers\n", count, totalMs,
+                count / (totalMs / 1000.0), renderThreads, bufferCount);
+    std::printf("mean render %.2f ms, mean encode %.2f ms per frame\n", render / count, encode / count);
+
+    if (!options.csv.empty()) {
+        FILE* f = std::fopen(options.csv.c_str(), "w");
+        if (!f) {
+            std::fprintf(stderr, "Could not write %s\n", options.csv.c_str());
+            return 1;
+        }
+        std::fprintf(f, "frame,angle,scale,projection,wait_ms,render_ms,encode_ms,latency_ms\n");
+        for (auto& t : timings)
+            std::fprintf(f, "%d,%.4f,%.4f,%s,%.3f,%.3f,%.3f,%.3f\n", t.params.frame, t.params.angle, t.params.scale,
+                         t.params.perspective ? "perspective" : "parallel", t.waitMs, t.renderMs, t.encodeMs,
+                         t.latencyMs);
+        ok = std::fclose(f) == 0 && ok;
+    }
+    if (!ok) std::fprintf(stderr, "Writing %s failed\n", options.output.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+/* Sutherland-Hodgman polygon clipping against any convex window, without heap traffic.
+Each boundary is applied in one pass that ping-pongs between two buffers owned by a
+caller-provided PolygonClipArena, so after the arena has grown to the largest polygon seen
+no further allocations happen. Batches of polygons are clipped into a reusable
+ClippedPolygons buffer. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Geometry.h"
+#include "Instrumentation.h"
+
+// ==== Clip Window ====
+
+// Inside when a*x + b*y + c >= 0
+struct ClipHalfPlane {
+    float a, b, c;
+
+    float distance(Vec2f p) const { return a * p.x + b * p.y + c; }
+};
+
+// Convex window stored as a fixed number of half-planes, so building one never allocates
+struct ConvexClipWindow {
+    static const int kMaxEdges = 32;
+
+    ClipHalfPlane planes[kMaxEdges];
+    int count = 0;
+
+    static ConvexClipWindow rectangle(float xmin, float ymin, float xmax, float ymax) {
+        Vec2f corners[4] = {{xmin, ymin}, {xmax, ymin}, {xmax, ymax}, {xmin, ymax}};
+        ConvexClipWindow w;
+        w.setPolygon(corners, 4);
+        return w;
+    }
+
+    // Vertices of a convex polygon in either winding; returns false if it has too many edges
+    bool setPolygon(const Vec2f* v, int n) {
+        if (n < 3 || n > kMaxEdges) return false;
+        float area = 0;
+        for (int i = 0; i < n; i++) area += cross({0, 0}, v[i], v[(i + 1) % n]);
+        float sign = area < 0 ? -1.0f : 1.0f;
+
+        count = n;
+        for (int i = 0; i < n; i++) {
+            Vec2f p = v[i], q = v[(i + 1) % n];
+            // Left of p -> q is inside for a counter-clockwise loop
+            float a = -(q.y - p.y) * sign, b = (q.x - p.x) * sign;
+            planes[i] = {a, b, -(a * p.x + b * p.y)};
+        }
+        return true;
+    }
+};
+
+// ==== Arena ====
+
+// Scratch buffers reused across calls; the clip result lives here until the next call
+class PolygonClipArena {
+public:
+    // Pre-size for convex polygons of up to maxVertices against windows of up to maxEdges
+    // edges. Concave polygons can grow the buffers further the first time they are clipped.
+    void reserve(size_t maxVertices, size_t maxEdges = 4) {
+        ensure(2 * (maxVertices + maxEdges));
+    }
+
+    // Grows both buffers to at least n vertices, keeping their contents
+    void ensure(size_t n) {
+        if (buffers[0].size() < n) {
+            buffers[0].resize(n);
+            buffers[1].resize(n);
+        }
+    }
+
+    std::vector<Vec2f> buffers[2];
+};
+
+// View into the arena returned by clipPolygon
+struct ClippedPolygon {
+    const Vec2f* vertices;
+    size_t size;
+
+    const Vec2f& operator[](size_t i) const { return vertices[i]; }
+    const Vec2f* begin() const { return vertices; }
+    const Vec2f* end() const { return vertices + size; }
+};
+
+// ==== Clipping ====
+
+// Clips src (n vertices) against one half-plane into dst; returns the output vertex count
+inline size_t clipAgainstPlane(const Vec2f* src, size_t n, const ClipHalfPlane& plane, Vec2f* dst) {
+    size_t out = 0;
+    Vec2f prev = src[n - 1];
+    float dPrev = plane.distance(prev);
+    for (size_t i = 0; i < n; i++) {
+        Vec2f curr = src[i];
+        float dCurr = plane.distance(curr);
+        if ((dPrev >= 0) != (dCurr >= 0)) {
+            float t = dPrev / (dPrev - dCurr);
+            dst[out++] = {prev.x + t * (curr.x - prev.x), prev.y + t * (curr.y - prev.y)};
+        }
+        if (dCurr >= 0) dst[out++] = curr;
+        prev = curr;
+        dPrev = dCurr;
+    }
+    return out;
+}
+
+// Clips one polygon. P is any type with x and y members (Vec2f, int points, ...).
+template <class P>
+ClippedPolygon clipPolygon(const P* poly, size_t n, const ConvexClipWindow& window, PolygonClipArena& arena) {
+    // A pass emits at most one intersection per input edge, so at most 2n vertices. A convex
+    // subject gains at most one per pass, but a concave one (a comb) can nearly double.
+    arena.ensure(2 * n);
+    int current = 0;
+    for (size_t i = 0; i < n; i++) arena.buffers[0][i] = {(float)poly[i].x, (float)poly[i].y};
+
+    for (int e = 0; e < window.count && n > 0; e++) {
+        arena.ensure(2 * n);
+        n = clipAgainstPlane(arena.buffers[current].data(), n, window.planes[e], arena.buffers[1 - current].data());
+        current = 1 - current;
+    }
+    GRAPHICS_COUNT("polygon_clip.vertices_out", n);
+    return {arena.buffers[current].data(), n};
+}
+
+// ==== Batches ====
+
+// Polygons packed back to back; polygon i is vertices[offsets[i] .. offsets[i + 1])
+struct ClippedPolygons {
+    std::vector<Vec2f> vertices;
+    std::vector<uint32_t> offsets = {0};
+
+    size_t count() const { return offsets.size() - 1; }
+    ClippedPolygon operator[](size_t i) const {
+        return {vertices.data() + offsets[i], offsets[i + 1] - offsets[i]};
+    }
+
+    // Keeps capacity so a reused batch does not allocate
+    void clear() {
+        vertices.clear();
+        offsets.resize(1);
+    }
+};
+
+// Clips polygons laid out like ClippedPolygons (offsets has polygonCount + 1 entries) and
+// appends the results to out. Polygons that vanish are kept as empty entries so indices match.
+inline void clipPolygons(const Vec2f* vertices, const uint32_t* offsets, size_t polygonCount,
+                         const ConvexClipWindow& window, PolygonClipArena& arena, ClippedPolygons& out) {
+    GRAPHICS_TIMED_SCOPE("polygon_clip.batch");
+    GRAPHICS_COUNT("polygon_clip.polygons", polygonCount);
+    for (size_t i = 0; i < polygonCount; i++) {
+        ClippedPolygon clipped = clipPolygon(vertices + offsets[i], offsets[i + 1] - offsets[i], window, arena);
+        out.vertices.insert(out.vertices.end(), clipped.begin(), clipped.end());
+        out.offsets.push_back((uint32_t)out.vertices.size());
+    }
+}
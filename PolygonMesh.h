@@ -0,0 +1,550 @@
+/* Indexed polygon mesh with OBJ/PLY import and a memory-mapped binary format.
+A mesh stores shared xyz positions once and faces (triangles, quads or any polygon) as runs of
+vertex indices. Two derived index lists are kept next to the faces: a fan triangulation for
+filled drawing and the list of unique edges, so a wireframe draws every shared edge once.
+
+The binary .mesh file is the mesh laid out exactly as it is used in memory: a fixed header
+followed by 64-byte aligned arrays. MappedMesh maps the file and points straight into it, so
+opening a model costs one mmap call and a header check however large it is; pages are read on
+first use. Files from untrusted sources can be opened with verifyIndices, which also scans
+every index once (and so reads every index page) before anything is drawn from them. */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Instrumentation.h"
+
+// ==== Mesh ====
+
+// Read-only view of a mesh; points either into a PolygonMesh or into a mapped file
+struct MeshView {
+    const float* positions = nullptr;    // xyz per vertex
+    const uint32_t* faceOffsets = nullptr;  // face i is corners[faceOffsets[i] .. faceOffsets[i + 1])
+    const uint32_t* corners = nullptr;
+    const uint32_t* triangles = nullptr;  // 3 indices per triangle
+    const uint32_t* edges = nullptr;      // 2 indices per unique edge
+    size_t vertexCount = 0, faceCount = 0, triangleCount = 0, edgeCount = 0;
+    float boundsMin[3] = {0, 0, 0}, boundsMax[3] = {0, 0, 0};
+
+    size_t cornerCount() const { return faceCount ? faceOffsets[faceCount] : 0; }
+};
+
+class PolygonMesh {
+public:
+    std::vector<float> positions;
+    std::vector<uint32_t> faceOffsets = {0};
+    std::vector<uint32_t> corners;
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> edges;
+    float boundsMin[3] = {0, 0, 0}, boundsMax[3] = {0, 0, 0};
+
+    size_t vertexCount() const { return positions.size() / 3; }
+    size_t faceCount() const { return faceOffsets.size() - 1; }
+
+    uint32_t addVertex(float x, float y, float z) {
+        positions.insert(positions.end(), {x, y, z});
+        return (uint32_t)vertexCount() - 1;
+    }
+
+    // Polygon through n vertices in order; it is fan-triangulated for filled drawing
+    void addFace(const uint32_t* index, size_t n) {
+        if (n < 3) return;
+        corners.insert(corners.end(), index, index + n);
+        faceOffsets.push_back((uint32_t)corners.size());
+        for (size_t i = 1; i + 1 < n; i++) triangles.insert(triangles.end(), {index[0], index[i], index[i + 1]});
+    }
+
+    void addFace(std::initializer_list<uint32_t> index) { addFace(index.begin(), index.size()); }
+
+    // Builds the unique edge list and the bounding box; call after the last addFace
+    void finalize() {
+        GRAPHICS_TIMED_SCOPE("mesh.finalize");
+        buildEdges();
+        GRAPHICS_COUNT("mesh.edges", edges.size() / 2);
+        computeBounds();
+    }
+
+    MeshView view() const {
+        MeshView v;
+        v.positions = positions.data();
+        v.faceOffsets = faceOffsets.data();
+        v.corners = corners.data();
+        v.triangles = triangles.data();
+        v.edges = edges.data();
+        v.vertexCount = vertexCount();
+        v.faceCount = faceCount();
+        v.triangleCount = triangles.size() / 3;
+        v.edgeCount = edges.size() / 2;
+        std::copy(boundsMin, boundsMin + 3, v.boundsMin);
+        std::copy(boundsMax, boundsMax + 3, v.boundsMax);
+        return v;
+    }
+
+    void clear() {
+        positions.clear();
+        faceOffsets.resize(1);
+        corners.clear();
+        triangles.clear();
+        edges.clear();
+    }
+
+private:
+    // Every face side as a (low, high) key; sorting puts shared sides next to each other
+    void buildEdges() {
+        std::vector<uint64_t> keys;
+        keys.reserve(corners.size());
+        for (size_t f = 0; f < faceCount(); f++) {
+            uint32_t begin = faceOffsets[f], end = faceOffsets[f + 1];
+            for (uint32_t i = begin; i < end; i++) {
+                uint32_t a = corners[i], b = corners[i + 1 < end ? i + 1 : begin];
+                if (a == b) continue;
+                keys.push_back(a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a);
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        edges.resize(keys.size() * 2);
+        for (size_t i = 0; i < keys.size(); i++) {
+            edges[i * 2] = (uint32_t)(keys[i] >> 32);
+            edges[i * 2 + 1] = (uint32_t)keys[i];
+        }
+    }
+
+    void computeBounds() {
+        for (int k = 0; k < 3; k++) {
+            boundsMin[k] = vertexCount() ? INFINITY : 0;
+            boundsMax[k] = vertexCount() ? -INFINITY : 0;
+        }
+        for (size_t i = 0; i < positions.size(); i += 3)
+            for (int k = 0; k < 3; k++) {
+                boundsMin[k] = std::min(boundsMin[k], positions[i + k]);
+                boundsMax[k] = std::max(boundsMax[k], positions[i + k]);
+            }
+    }
+};
+
+// ==== Text Import ====
+
+namespace mesh_detail {
+
+// Whole file into memory with a terminating zero, so the parsers can run off the end safely
+inline bool readFile(const std::string& path, std::vector<char>& data) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    data.resize(size > 0 ? size + 1 : 1);
+    bool ok = size <= 0 || std::fread(data.data(), 1, size, f) == (size_t)size;
+    data.back() = 0;
+    std::fclose(f);
+    return ok;
+}
+
+inline const char* skipSpaces(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+    return p;
+}
+
+inline const char* nextLine(const char* p) {
+    while (*p && *p != '\n') p++;
+    return *p ? p + 1 : p;
+}
+
+inline bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    if (s.size() < n) return false;
+    for (size_t i = 0; i < n; i++)
+        if (std::tolower((unsigned char)s[s.size() - n + i]) != suffix[i]) return false;
+    return true;
+}
+
+}  // namespace mesh_detail
+
+// Wavefront OBJ: "v" positions and "f" faces (v, v/vt, v//vn, v/vt/vn; negative indices count
+// back from the latest vertex). Everything else is ignored.
+inline bool loadOBJ(const std::string& path, PolygonMesh& mesh) {
+    using namespace mesh_detail;
+    std::vector<char> data;
+    if (!readFile(path, data)) return false;
+    mesh.clear();
+    std::vector<uint32_t> face;
+    for (const char* p = data.data(); *p; p = nextLine(p)) {
+        p = skipSpaces(p);
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            char* end;
+            float x = std::strtof(p + 2, &end);
+            float y = std::strtof(end, &end);
+            float z = std::strtof(end, &end);
+            mesh.addVertex(x, y, z);
+            p = end;
+        } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            face.clear();
+            p += 2;
+            while (true) {
+                p = skipSpaces(p);
+                if (*p == '\n' || !*p) break;
+                char* end;
+                long index = std::strtol(p, &end, 10);
+                if (end == p) break;
+                long vertex = index < 0 ? (long)mesh.vertexCount() + index : index - 1;
+                if (vertex < 0 || vertex >= (long)mesh.vertexCount()) return false;
+                face.push_back((uint32_t)vertex);
+                p = end;
+                while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;  // /vt/vn
+            }
+            mesh.addFace(face.data(), face.size());
+        }
+    }
+    mesh.finalize();
+    return true;
+}
+
+namespace mesh_detail {
+
+enum PlyType { PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64 };
+
+struct PlyProperty {
+    std::string name;
+    PlyType type;
+    bool list = false;
+    PlyType countType = PLY_UINT8;
+};
+
+struct PlyElement {
+    std::string name;
+    size_t count;
+    std::vector<PlyProperty> properties;
+};
+
+inline bool plyType(const std::string& name, PlyType& type) {
+    static const char* names[][2] = {{"char", "int8"},   {"uchar", "uint8"},  {"short", "int16"},
+                                     {"ushort", "uint16"}, {"int", "int32"},    {"uint", "uint32"},
+                                     {"float", "float32"}, {"double", "float64"}};
+    for (int i = 0; i < 8; i++)
+        if (name == names[i][0] || name == names[i][1]) {
+            type = (PlyType)i;
+            return true;
+        }
+    return false;
+}
+
+inline int plySize(PlyType type) {
+    static const int sizes[] = {1, 1, 2, 2, 4, 4, 4, 8};
+    return sizes[type];
+}
+
+// Reads one value into v and advances p; ascii values are whitespace separated. Returns false
+// at the end of the data or on text that is not a number.
+inline bool plyValue(const char*& p, const char* end, PlyType type, int format, double& v) {
+    if (p >= end) return false;
+    if (format == 0) {
+        char* next;
+        v = std::strtod(p, &next);
+        if (next == p) return false;
+        p = next;
+        return true;
+    }
+    uint8_t bytes[8] = {};
+    int n = plySize(type);
+    if (end - p < n) return false;
+    for (int i = 0; i < n; i++) bytes[i] = (uint8_t)p[format == 2 ? n - 1 - i : i];  // 2: big endian
+    p += n;
+    switch (type) {
+        case PLY_INT8: v = (int8_t)bytes[0]; break;
+        case PLY_UINT8: v = bytes[0]; break;
+        case PLY_INT16: { int16_t x; std::memcpy(&x, bytes, 2); v = x; break; }
+        case PLY_UINT16: { uint16_t x; std::memcpy(&x, bytes, 2); v = x; break; }
+        case PLY_INT32: { int32_t x; std::memcpy(&x, bytes, 4); v = x; break; }
+        case PLY_UINT32: { uint32_t x; std::memcpy(&x, bytes, 4); v = x; break; }
+        case PLY_FLOAT32: { float x; std::memcpy(&x, bytes, 4); v = x; break; }
+        default: std::memcpy(&v, bytes, 8); break;
+    }
+    return true;
+}
+
+// A list length or vertex index: integral, non-negative and no larger than limit. Checked
+// before the cast, since converting a negative or huge double to an unsigned type is undefined.
+inline bool plyIndex(double v, double limit) {
+    return v >= 0 && v <= limit && v == std::floor(v);
+}
+
+}  // namespace mesh_detail
+
+// Stanford PLY, ascii or binary (either byte order): vertex x/y/z and face vertex_indices
+// (or vertex_index); other elements and properties are skipped.
+inline bool loadPLY(const std::string& path, PolygonMesh& mesh) {
+    using namespace mesh_detail;
+    std::vector<char> data;
+    if (!readFile(path, data) || std::strncmp(data.data(), "ply", 3) != 0) return false;
+    mesh.clear();
+
+    int format = -1;  // 0 ascii, 1 little endian, 2 big endian
+    std::vector<PlyElement> elements;
+    const char* p = data.data();
+    const char* end = data.data() + data.size() - 1;
+    while (true) {
+        p = nextLine(p);
+        if (!*p) return false;
+        const char* lineEnd = std::strchr(p, '\n');
+        std::string line(p, lineEnd ? lineEnd : end);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        char a[64] = "", b[64] = "", c[64] = "", d[64] = "";
+        int n = std::sscanf(line.c_str(), "%63s %63s %63s %63s", a, b, c, d);
+        std::string keyword = n > 0 ? a : "";
+        if (keyword == "format") {
+            std::string f = b;
+            format = f == "ascii" ? 0 : f == "binary_little_endian" ? 1 : f == "binary_big_endian" ? 2 : -1;
+            if (format < 0) return false;
+        } else if (keyword == "element" && n == 3) {
+            elements.push_back({b, (size_t)std::strtoull(c, nullptr, 10), {}});
+        } else if (keyword == "property" && !elements.empty()) {
+            PlyProperty prop;
+            if (std::string(b) == "list" && n == 4) {
+                char name[64] = "";
+                std::sscanf(line.c_str(), "%*s %*s %*s %*s %63s", name);
+                prop.list = true;
+                prop.name = name;
+                if (!plyType(c, prop.countType) || !plyType(d, prop.type)) return false;
+            } else {
+                prop.name = c;
+                if (!plyType(b, prop.type)) return false;
+            }
+            elements.back().properties.push_back(prop);
+        } else if (keyword == "end_header") {
+            p = nextLine(p);
+            break;
+        }
+    }
+    if (format < 0) return false;
+
+    std::vector<uint32_t> face;
+    for (const PlyElement& element : elements) {
+        bool isVertex = element.name == "vertex", isFace = element.name == "face";
+        int axis[3] = {-1, -1, -1}, indexList = -1;
+        for (size_t k = 0; k < element.properties.size(); k++) {
+            const std::string& name = element.properties[k].name;
+            if (name == "x") axis[0] = (int)k;
+            if (name == "y") axis[1] = (int)k;
+            if (name == "z") axis[2] = (int)k;
+            if (element.properties[k].list && (name == "vertex_indices" || name == "vertex_index")) indexList = (int)k;
+        }
+        for (size_t i = 0; i < element.count; i++) {
+            float xyz[3] = {0, 0, 0};
+            for (size_t k = 0; k < element.properties.size(); k++) {
+                const PlyProperty& prop = element.properties[k];
+                if (prop.list) {
+                    // Every entry takes at least one byte (binary: its size; ascii: a digit), so
+                    // a count larger than what is left of the file is corrupt
+                    double length;
+                    size_t entryBytes = format == 0 ? 1 : (size_t)plySize(prop.type);
+                    if (!plyValue(p, end, prop.countType, format, length) ||
+                        !plyIndex(length, (double)((end - p) / entryBytes)))
+                        return false;
+                    size_t count = (size_t)length;
+                    face.clear();
+                    for (size_t j = 0; j < count; j++) {
+                        double v;
+                        if (!plyValue(p, end, prop.type, format, v)) return false;
+                        if ((int)k != indexList) continue;
+                        if (!plyIndex(v, UINT32_MAX)) return false;
+                        face.push_back((uint32_t)v);
+                    }
+                    if (isFace && (int)k == indexList) {
+                        for (uint32_t v : face)
+                            if (v >= mesh.vertexCount()) return false;
+                        mesh.addFace(face.data(), face.size());
+                    }
+                } else {
+                    double v;
+                    if (!plyValue(p, end, prop.type, format, v)) return false;
+                    for (int a = 0; a < 3; a++)
+                        if ((int)k == axis[a]) xyz[a] = (float)v;
+                }
+            }
+            if (isVertex) mesh.addVertex(xyz[0], xyz[1], xyz[2]);
+            if (p >= end && i + 1 < element.count) return false;
+        }
+    }
+    mesh.finalize();
+    return true;
+}
+
+// ==== Binary Format ====
+
+// On-disk layout, native (little endian) byte order. Every array starts at a multiple of
+// kMeshAlignment from the start of the file.
+struct MeshFileHeader {
+    char magic[8];      // "PMESH\0\0\1"
+    uint64_t fileSize;
+    uint64_t vertexCount, faceCount, cornerCount, triangleCount, edgeCount;
+    uint64_t positionsOffset, faceOffsetsOffset, cornersOffset, trianglesOffset, edgesOffset;
+    float boundsMin[3], boundsMax[3];
+};
+
+static const char kMeshMagic[8] = {'P', 'M', 'E', 'S', 'H', 0, 0, 1};
+static const uint64_t kMeshAlignment = 64;
+
+inline bool writeMeshFile(const MeshView& mesh, const std::string& path) {
+    MeshFileHeader h = {};
+    std::memcpy(h.magic, kMeshMagic, 8);
+    h.vertexCount = mesh.vertexCount;
+    h.faceCount = mesh.faceCount;
+    h.cornerCount = mesh.cornerCount();
+    h.triangleCount = mesh.triangleCount;
+    h.edgeCount = mesh.edgeCount;
+    std::copy(mesh.boundsMin, mesh.boundsMin + 3, h.boundsMin);
+    std::copy(mesh.boundsMax, mesh.boundsMax + 3, h.boundsMax);
+
+    const void* arrays[5] = {mesh.positions, mesh.faceOffsets, mesh.corners, mesh.triangles, mesh.edges};
+    uint64_t bytes[5] = {h.vertexCount * 3 * sizeof(float), (h.faceCount + 1) * sizeof(uint32_t),
+                         h.cornerCount * sizeof(uint32_t), h.triangleCount * 3 * sizeof(uint32_t),
+                         h.edgeCount * 2 * sizeof(uint32_t)};
+    uint64_t* offsets[5] = {&h.positionsOffset, &h.faceOffsetsOffset, &h.cornersOffset, &h.trianglesOffset,
+                            &h.edgesOffset};
+    uint64_t pos = (sizeof(h) + kMeshAlignment - 1) / kMeshAlignment * kMeshAlignment;
+    for (int i = 0; i < 5; i++) {
+        *offsets[i] = pos;
+        pos = (pos + bytes[i] + kMeshAlignment - 1) / kMeshAlignment * kMeshAlignment;
+    }
+    h.fileSize = pos;
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    static const uint32_t emptyOffsets[1] = {0};
+    if (!mesh.faceOffsets) arrays[1] = emptyOffsets;
+    static const char padding[kMeshAlignment] = {};
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    uint64_t written = sizeof(h);
+    for (int i = 0; i < 5 && ok; i++) {
+        ok = std::fwrite(padding, 1, *offsets[i] - written, f) == *offsets[i] - written;
+        if (bytes[i]) ok = ok && std::fwrite(arrays[i], 1, bytes[i], f) == bytes[i];
+        written = *offsets[i] + bytes[i];
+    }
+    ok = ok && std::fwrite(padding, 1, h.fileSize - written, f) == h.fileSize - written;
+    return std::fclose(f) == 0 && ok;
+}
+
+// Read-only mapping of a .mesh file; view() points into the mapping and is valid until the
+// MappedMesh is closed or destroyed
+class MappedMesh {
+public:
+    MappedMesh() = default;
+    explicit MappedMesh(const std::string& path) { open(path); }
+    ~MappedMesh() { close(); }
+
+    MappedMesh(const MappedMesh&) = delete;
+    MappedMesh& operator=(const MappedMesh&) = delete;
+
+    // verifyIndices also checks every face offset and index against the vertex count, which
+    // costs a pass over the index arrays
+    bool open(const std::string& path, bool verifyIndices = false) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(MeshFileHeader)) {
+            size = st.st_size;
+            void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            base = p == MAP_FAILED ? nullptr : static_cast<const char*>(p);
+        }
+        ::close(fd);
+        if (!base || !validateHeader() || (verifyIndices && !validateIndices())) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(const_cast<char*>(base), size);
+        base = nullptr;
+        size = 0;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+
+    MeshView view() const {
+        MeshView v;
+        if (!base) return v;
+        const MeshFileHeader& h = header();
+        v.positions = reinterpret_cast<const float*>(base + h.positionsOffset);
+        v.faceOffsets = reinterpret_cast<const uint32_t*>(base + h.faceOffsetsOffset);
+        v.corners = reinterpret_cast<const uint32_t*>(base + h.cornersOffset);
+        v.triangles = reinterpret_cast<const uint32_t*>(base + h.trianglesOffset);
+        v.edges = reinterpret_cast<const uint32_t*>(base + h.edgesOffset);
+        v.vertexCount = h.vertexCount;
+        v.faceCount = h.faceCount;
+        v.triangleCount = h.triangleCount;
+        v.edgeCount = h.edgeCount;
+        std::copy(h.boundsMin, h.boundsMin + 3, v.boundsMin);
+        std::copy(h.boundsMax, h.boundsMax + 3, v.boundsMax);
+        return v;
+    }
+
+private:
+    const MeshFileHeader& header() const { return *reinterpret_cast<const MeshFileHeader*>(base); }
+
+    // Header against the file: the arrays fit and the counts agree. Touches only the header
+    // and the ends of the face offsets.
+    bool validateHeader() const {
+        const MeshFileHeader& h = header();
+        if (std::memcmp(h.magic, kMeshMagic, 8) != 0 || h.fileSize != size) return false;
+        auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+            return offset % kMeshAlignment == 0 && offset <= size && count <= (size - offset) / elementSize;
+        };
+        if (h.faceCount >= size || h.vertexCount > UINT32_MAX ||
+            !fits(h.positionsOffset, h.vertexCount, 3 * sizeof(float)) ||
+            !fits(h.faceOffsetsOffset, h.faceCount + 1, sizeof(uint32_t)) ||
+            !fits(h.cornersOffset, h.cornerCount, sizeof(uint32_t)) ||
+            !fits(h.trianglesOffset, h.triangleCount, 3 * sizeof(uint32_t)) ||
+            !fits(h.edgesOffset, h.edgeCount, 2 * sizeof(uint32_t)))
+            return false;
+
+        const uint32_t* faceOffsets = reinterpret_cast<const uint32_t*>(base + h.faceOffsetsOffset);
+        return faceOffsets[0] == 0 && faceOffsets[h.faceCount] == h.cornerCount;
+    }
+
+    // Every index: the arrays go straight to glDrawElements and the edge walks, so a corrupt
+    // file must not index past the positions. Face offsets must never decrease.
+    bool validateIndices() const {
+        const MeshFileHeader& h = header();
+        const uint32_t* faceOffsets = reinterpret_cast<const uint32_t*>(base + h.faceOffsetsOffset);
+        for (uint64_t f = 0; f < h.faceCount; f++)
+            if (faceOffsets[f] > faceOffsets[f + 1]) return false;
+
+        auto indicesValid = [&](uint64_t offset, uint64_t count) {
+            const uint32_t* index = reinterpret_cast<const uint32_t*>(base + offset);
+            uint32_t largest = 0;
+            for (uint64_t i = 0; i < count; i++) largest = std::max(largest, index[i]);
+            return count == 0 || largest < h.vertexCount;
+        };
+        return indicesValid(h.cornersOffset, h.cornerCount) &&
+               indicesValid(h.trianglesOffset, h.triangleCount * 3) &&
+               indicesValid(h.edgesOffset, h.edgeCount * 2);
+    }
+
+    const char* base = nullptr;
+    size_t size = 0;
+};
+
+// Imports a text model by extension (.obj or .ply)
+inline bool loadMesh(const std::string& path, PolygonMesh& mesh) {
+    if (mesh_detail::endsWith(path, ".obj")) return loadOBJ(path, mesh);
+    if (mesh_detail::endsWith(path, ".ply")) return loadPLY(path, mesh);
+    return false;
+}
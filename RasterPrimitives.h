@@ -0,0 +1,135 @@
+/* Scan-conversion of lines, circles and ellipses into a Framebuffer.
+Integer-only Bresenham and midpoint algorithms in the framebuffer's current color. A line whose
+end points are both inside the buffer walks a pixel pointer directly; anything else goes
+through the clipped plot(). */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+#include "Framebuffer.h"
+#include "Instrumentation.h"
+
+// Bresenham's line from (x0, y0) to (x1, y1), both end points included. Steps one pixel
+// along the major axis and moves on the minor axis when the decision parameter is >= 0, or
+// only when it is > 0 with stepOnTie false (the rule DrawnClip has always used), which
+// changes which pixel is picked where the line passes exactly halfway between two.
+inline void bresenhamLine(Framebuffer& fb, int x0, int y0, int x1, int y1, bool stepOnTie = true) {
+    GRAPHICS_TIMED_SCOPE("raster.line");
+    int dx = std::abs(x1 - x0), dy = std::abs(y1 - y0);
+    int sx = x1 >= x0 ? 1 : -1, sy = y1 >= y0 ? 1 : -1;
+    bool steep = dy > dx;
+    if (steep) std::swap(dx, dy);
+    GRAPHICS_COUNT("raster.line.pixels", dx + 1);
+
+    // Pointer steps along the major and minor axes
+    int major = steep ? sy * fb.stride : sx, minor = steep ? sx : sy * fb.stride;
+    int p = 2 * dy - dx;
+    int threshold = stepOnTie ? -1 : 0;  // move on the minor axis when p > threshold
+    bool inside = (unsigned)x0 < (unsigned)fb.width && (unsigned)y0 < (unsigned)fb.height &&
+                  (unsigned)x1 < (unsigned)fb.width && (unsigned)y1 < (unsigned)fb.height;
+    if (inside) {
+        uint32_t* pixel = fb.row(y0) + x0;
+        for (int i = 0;; i++) {
+            *pixel = fb.color;
+            if (i == dx) break;
+            if (p > threshold) {
+                pixel += minor;
+                p -= 2 * dx;
+            }
+            pixel += major;
+            p += 2 * dy;
+        }
+        return;
+    }
+
+    int x = x0, y = y0;
+    for (int i = 0; i <= dx; i++) {
+        fb.plot(x, y);
+        if (p > threshold) {
+            if (steep) x += sx;
+            else y += sy;
+            p -= 2 * dx;
+        }
+        if (steep) y += sy;
+        else x += sx;
+        p += 2 * dy;
+    }
+}
+
+// Midpoint circle: one octant is stepped and mirrored into the other seven
+inline void midpointCircle(Framebuffer& fb, int xc, int yc, int radius) {
+    GRAPHICS_TIMED_SCOPE("raster.circle");
+    int x = 0, y = radius;
+    int d = 1 - radius;
+    while (x <= y) {
+        fb.plot(xc + x, yc + y);
+        fb.plot(xc - x, yc + y);
+        fb.plot(xc + x, yc - y);
+        fb.plot(xc - x, yc - y);
+        fb.plot(xc + y, yc + x);
+        fb.plot(xc - y, yc + x);
+        fb.plot(xc + y, yc - x);
+        fb.plot(xc - y, yc - x);
+        if (d < 0) d += 2 * x + 3;
+        else {
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
+    GRAPHICS_COUNT("raster.circle.pixels", 8 * x);
+}
+
+// Midpoint ellipse with radii rx, ry. The decision variables are kept four times too large
+// so the half-pixel terms stay integral; 64-bit so radii in the thousands cannot overflow.
+inline void midpointEllipse(Framebuffer& fb, int xc, int yc, int rx, int ry) {
+    GRAPHICS_TIMED_SCOPE("raster.ellipse");
+    if (rx < 0 || ry < 0) return;
+    if (ry == 0) {
+        fb.span(xc - rx, xc + rx, yc);
+        return;
+    }
+    auto plot4 = [&](int x, int y) {
+        fb.plot(xc + x, yc + y);
+        fb.plot(xc - x, yc + y);
+        fb.plot(xc + x, yc - y);
+        fb.plot(xc - x, yc - y);
+    };
+    int64_t rx2 = (int64_t)rx * rx, ry2 = (int64_t)ry * ry;
+    int x = 0, y = ry;
+    int64_t px = 0, py = 2 * rx2 * y;
+
+    // Region 1: slope shallower than -1, step x
+    int64_t p = 4 * ry2 - 4 * rx2 * ry + rx2;
+    plot4(x, y);
+    while (px < py) {
+        x++;
+        px += 2 * ry2;
+        if (p < 0) p += 4 * (ry2 + px);
+        else {
+            y--;
+            py -= 2 * rx2;
+            p += 4 * (ry2 + px - py);
+        }
+        plot4(x, y);
+    }
+
+    // Region 2: step y
+    p = ry2 * (2 * (int64_t)x + 1) * (2 * (int64_t)x + 1) + 4 * rx2 * ((int64_t)y - 1) * ((int64_t)y - 1) -
+        4 * rx2 * ry2;
+    while (y > 0) {
+        y--;
+        py -= 2 * rx2;
+        if (p > 0) p += 4 * (rx2 - py);
+        else {
+            x++;
+            px += 2 * ry2;
+            p += 4 * (rx2 - py + px);
+        }
+        plot4(x, y);
+    }
+    GRAPHICS_COUNT("raster.ellipse.pixels", 4 * (x + ry));
+}
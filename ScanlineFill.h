@@ -0,0 +1,204 @@
+/* Edge-table / active-edge-table scanline polygon filler.
+Edges are built once into a table sorted by their first scanline; each scanline adds the
+edges that start there to the active edge list, drops finished ones, and steps every active
+x by its 16.16 fixed-point slope, so there is no per-scanline rescan and no division in the
+inner loop. The fixed-point values are 64-bit so long edges, near-horizontal slopes and
+coordinates far outside the target cannot overflow. Polygons may have several contours and
+are filled with the even-odd or nonzero winding rule. The target is split into horizontal
+bands that can be filled in parallel.
+
+Pixel (x, y) is covered when its center (x + 0.5, y + 0.5) is inside the polygon, so
+polygons that share an edge never fill the same pixel twice. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Framebuffer.h"
+#include "Geometry.h"
+#include "Instrumentation.h"
+#include "ThreadPool.h"
+
+enum FillRule { FILL_EVEN_ODD, FILL_NONZERO };
+
+// Polygons to fill in one call. A polygon is one or more closed contours plus a color;
+// later polygons are drawn over earlier ones.
+struct FillPolygons {
+    std::vector<Vec2f> vertices;
+    std::vector<uint32_t> contours = {0};  // contour i is vertices[contours[i] .. contours[i + 1])
+    std::vector<uint32_t> polygons = {0};  // polygon j is contours[polygons[j] .. polygons[j + 1])
+    std::vector<uint32_t> colors;          // packed RGBA, one per polygon
+
+    size_t count() const { return colors.size(); }
+
+    template <class P>
+    void addContour(const P* points, size_t n) {
+        for (size_t i = 0; i < n; i++) vertices.push_back({(float)points[i].x, (float)points[i].y});
+        contours.push_back((uint32_t)vertices.size());
+    }
+
+    // Closes the polygon made of the contours added since the previous call
+    void endPolygon(uint32_t color) {
+        polygons.push_back((uint32_t)contours.size() - 1);
+        colors.push_back(color);
+    }
+
+    void clear() {
+        vertices.clear();
+        contours.resize(1);
+        polygons.resize(1);
+        colors.clear();
+    }
+};
+
+class ScanlineFiller {
+public:
+    // Fills every polygon into fb. With a pool the rows are split into bands of bandHeight
+    // scanlines (0 picks a height that gives each thread a few bands).
+    void fill(Framebuffer& fb, const FillPolygons& polys, FillRule rule = FILL_EVEN_ODD,
+              ThreadPool* pool = nullptr, int bandHeight = 0) {
+        GRAPHICS_TIMED_SCOPE("scanline.fill");
+        buildEdgeTable(polys, fb.height);
+        GRAPHICS_COUNT("scanline.edges", edges.size());
+        if (fb.height <= 0 || edges.empty()) return;
+
+        size_t threads = pool ? pool->size() : 1;
+        if (bandHeight <= 0)
+            bandHeight = threads == 1 ? fb.height : std::max(16, (int)(fb.height / (threads * 4)));
+        int bands = (fb.height + bandHeight - 1) / bandHeight;
+        if ((int)active.size() < bands) active.resize(bands);
+
+        auto fillBand = [&](size_t band) {
+            int y0 = (int)band * bandHeight;
+            int y1 = std::min(y0 + bandHeight, fb.height);
+            for (size_t p = 0; p < ranges.size(); p++)
+                fillPolygonRows(fb, p, polys.colors[p], rule, y0, y1, active[band]);
+        };
+        if (pool) pool->parallelFor(bands, fillBand);
+        else for (int b = 0; b < bands; b++) fillBand(b);
+    }
+
+private:
+    struct Edge {
+        int yStart, yEnd;  // scanlines [yStart, yEnd)
+        int64_t x;         // 16.16 x at the center of scanline yStart
+        int64_t dxdy;      // 16.16 x step per scanline
+        int winding;       // +1 for upward edges, -1 for downward
+    };
+
+    struct ActiveEdge {
+        int64_t x, dxdy;
+        int yEnd, winding;
+    };
+
+    // Edges of polygon p are edges[first .. last), sorted by yStart
+    struct PolygonRange {
+        size_t first, last;
+        int yMin, yMax;
+    };
+
+    // 16.16 values are clamped to +-2^46 (2^30 pixels), far outside any target, so x plus a
+    // step per scanline of the tallest target stays well inside 64 bits
+    static int64_t toFixed(double v) {
+        const double limit = 70368744177664.0;
+        return (int64_t)std::llround(std::max(-limit, std::min(v * 65536.0, limit)));
+    }
+
+    // Column of the first pixel center at or right of a 16.16 x, clamped to just outside fb
+    static int pixelColumn(int64_t x, int width) {
+        return (int)std::max<int64_t>(-1, std::min<int64_t>((x + 0x7FFF) >> 16, width));
+    }
+
+    void buildEdgeTable(const FillPolygons& polys, int height) {
+        edges.clear();
+        ranges.clear();
+        for (size_t p = 0; p < polys.count(); p++) {
+            PolygonRange range = {edges.size(), 0, height, 0};
+            for (uint32_t c = polys.polygons[p]; c < polys.polygons[p + 1]; c++) {
+                uint32_t begin = polys.contours[c], end = polys.contours[c + 1];
+                for (uint32_t i = begin; i < end; i++) {
+                    Vec2f a = polys.vertices[i];
+                    Vec2f b = polys.vertices[i + 1 < end ? i + 1 : begin];
+                    int winding = 1;
+                    if (a.y > b.y) { std::swap(a, b); winding = -1; }
+
+                    // Scanlines whose centers lie in [a.y, b.y), clamped before the int conversion
+                    float top = (float)height;
+                    int yStart = (int)std::ceil(std::min(std::max(a.y - 0.5f, 0.0f), top));
+                    int yEnd = (int)std::ceil(std::min(std::max(b.y - 0.5f, 0.0f), top));
+                    if (yStart >= yEnd) continue;
+
+                    double slope = (double)(b.x - a.x) / (b.y - a.y);
+                    double x = a.x + (yStart + 0.5 - a.y) * slope;
+                    edges.push_back({yStart, yEnd, toFixed(x), toFixed(slope), winding});
+                    range.yMin = std::min(range.yMin, yStart);
+                    range.yMax = std::max(range.yMax, yEnd);
+                }
+            }
+            range.last = edges.size();
+            std::sort(edges.begin() + range.first, edges.begin() + range.last,
+                      [](const Edge& l, const Edge& r) { return l.yStart < r.yStart; });
+            ranges.push_back(range);
+        }
+    }
+
+    void fillPolygonRows(Framebuffer& fb, size_t p, uint32_t color, FillRule rule,
+                         int y0, int y1, std::vector<ActiveEdge>& aet) const {
+        const PolygonRange& range = ranges[p];
+        y0 = std::max(y0, range.yMin);
+        y1 = std::min(y1, range.yMax);
+        if (y0 >= y1) return;
+
+        // Edges that started above this band enter part way down
+        aet.clear();
+        size_t next = range.first;
+        for (; next < range.last && edges[next].yStart <= y0; next++) {
+            const Edge& e = edges[next];
+            if (e.yEnd > y0)
+                aet.push_back({e.x + e.dxdy * (int64_t)(y0 - e.yStart), e.dxdy, e.yEnd, e.winding});
+        }
+
+        size_t spans = 0;
+        for (int y = y0; y < y1; y++) {
+            for (; next < range.last && edges[next].yStart == y; next++) {
+                const Edge& e = edges[next];
+                aet.push_back({e.x, e.dxdy, e.yEnd, e.winding});
+            }
+
+            // Drop finished edges, then restore x order; the list stays nearly sorted
+            // between scanlines, so insertion sort is close to linear
+            aet.erase(std::remove_if(aet.begin(), aet.end(), [y](const ActiveEdge& e) { return e.yEnd <= y; }),
+                      aet.end());
+            for (size_t i = 1; i < aet.size(); i++) {
+                ActiveEdge e = aet[i];
+                size_t j = i;
+                for (; j > 0 && aet[j - 1].x > e.x; j--) aet[j] = aet[j - 1];
+                aet[j] = e;
+            }
+
+            // Fill between crossings where the rule says we are inside
+            int winding = 0;
+            for (size_t i = 0; i + 1 < aet.size(); i++) {
+                winding += rule == FILL_NONZERO ? aet[i].winding : 1;
+                bool inside = rule == FILL_NONZERO ? winding != 0 : (winding & 1);
+                if (!inside) continue;
+                int xl = pixelColumn(aet[i].x, fb.width);
+                int xr = pixelColumn(aet[i + 1].x, fb.width) - 1;
+                if (xl <= xr) {
+                    fb.span(xl, xr, y, color);
+                    spans++;
+                }
+            }
+
+            for (auto& e : aet) e.x += e.dxdy;
+        }
+        GRAPHICS_COUNT("scanline.spans", spans);
+    }
+
+    std::vector<Edge> edges;
+    std::vector<PolygonRange> ranges;
+    std::vector<std::vector<ActiveEdge>> active;  // one active edge list per band
+};
@@ -4,6 +4,13 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "Framebuffer.h"
+#include "FramebufferGL.h"
+#include "ScanlineFill.h"
 
 using namespace std;
 
@@ -26,7 +33,11 @@ bool compareEdge(pair<int, int> p1, pair<int, int> p2) {
     return p1.second < p2.second;
 }
 
-// Function to fill the polygon using the Scan Line Fill Algorithm
+// Filled spans are written here and uploaded once per frame
+Framebuffer framebuffer(500, 500);
+
+// Function to fill the polygon using the Scan Line Fill Algorithm. Every scanline rescans
+// every edge; kept as the reference for --bench.
 void scanLineFill(vector<pair<int, int>> poly) {
     int ymax = 0;
     int ymin = 9999;
@@ -60,35 +71,238 @@ void scanLineFill(vector<pair<int, int>> poly) {
         sort(intersections.begin(), intersections.end());
 
         // Fill the pixels between the pairs of intersections
-        for (int i = 0; i < intersections.size(); i += 2) {
-            glBegin(GL_LINES);
-            glVertex2i(intersections[i], y);
-            glVertex2i(intersections[i + 1], y);
-            glEnd();
+        for (size_t i = 0; i + 1 < intersections.size(); i += 2) {
+            framebuffer.span(intersections[i], intersections[i + 1], y);
         }
     }
 }
 
+// Edge table filler used for display, and the polygon in its input format
+ScanlineFiller filler;
+FillPolygons fillPolygons;
+
 void display() {
     glClear(GL_COLOR_BUFFER_BIT);
 
+    // Fill the polygon using the edge table / active edge table filler (green)
+    framebuffer.clear(1, 1, 1);
+    filler.fill(framebuffer, fillPolygons);
+    GLUTTarget().present(framebuffer);
+
     // Draw the original polygon (blue)
     glColor3f(0, 0, 1); // Blue for the polygon outline
     plotPolygon(polygon);
 
-    // Fill the polygon using Scan Line Fill Algorithm (green)
-    glColor3f(0, 1, 0); // Green for filling
-    scanLineFill(polygon);
-
     glFlush();
 }
 
+// Random star-shaped polygons, some self-intersecting so the fill rules differ
+FillPolygons randomPolygons(mt19937& rng, int count, int vertices, int size) {
+    uniform_real_distribution<float> center(0, size), radius(size / 16.0f, size / 4.0f), unit(0, 1);
+    FillPolygons polys;
+    vector<Vec2f> contour(vertices);
+    for (int p = 0; p < count; p++) {
+        float cx = center(rng), cy = center(rng), r = radius(rng);
+        int turns = unit(rng) < 0.25f ? 2 : 1;
+        for (int i = 0; i < vertices; i++) {
+            float a = 2 * 3.14159265f * turns * i / vertices;
+            float d = r * (0.5f + 0.5f * unit(rng));
+            contour[i] = {cx + d * cos(a), cy + d * sin(a)};
+        }
+        polys.addContour(contour.data(), contour.size());
+        polys.endPolygon(Framebuffer::pack(unit(rng), unit(rng), unit(rng)));
+    }
+    return polys;
+}
+
+// Compare scanLineFill against the edge table filler, single threaded and in bands
+int benchmarkFill() {
+    const int size = 2048;
+    Framebuffer fb(size, size);
+    ThreadPool pool;
+    mt19937 rng(2024);
+
+    auto timeMs = [](auto&& fn) {
+        auto t0 = chrono::steady_clock::now();
+        fn();
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    };
+
+    cout << "threads: " << pool.size() << ", target " << size << "x" << size << "\n";
+    cout << "polygons vertices   scanLineFill(ms)   edge table(ms)   banded(ms)   speedup\n";
+    const int cases[][2] = {{100, 8}, {100, 64}, {1000, 16}, {1000, 128}, {10000, 32}};
+    for (auto& c : cases) {
+        FillPolygons polys = randomPolygons(rng, c[0], c[1], size);
+
+        double legacy = timeMs([&] {
+            swap(framebuffer, fb);
+            for (size_t p = 0; p < polys.count(); p++) {
+                vector<pair<int, int>> poly;
+                uint32_t c = polys.polygons[p];
+                for (uint32_t i = polys.contours[c]; i < polys.contours[c + 1]; i++)
+                    poly.push_back({(int)polys.vertices[i].x, (int)polys.vertices[i].y});
+                framebuffer.setColor(polys.colors[p]);
+                scanLineFill(poly);
+            }
+            swap(framebuffer, fb);
+        });
+        ScanlineFiller edgeTable;
+        double single = timeMs([&] { edgeTable.fill(fb, polys, FILL_EVEN_ODD); });
+        double banded = timeMs([&] { edgeTable.fill(fb, polys, FILL_EVEN_ODD, &pool); });
+
+        printf("%8d %8d %18.2f %16.2f %12.2f %8.1fx\n", c[0], c[1], legacy, single, banded,
+               legacy / min(single, banded));
+    }
+    return 0;
+}
+
+// ==== Verification ====
+
+// Distance from (px, py) to the nearest edge of a single-contour polygon
+float boundaryDistance(const vector<Vec2f>& poly, float px, float py) {
+    float best = INFINITY;
+    for (size_t i = 0; i < poly.size(); i++) {
+        Vec2f a = poly[i], b = poly[(i + 1) % poly.size()];
+        float dx = b.x - a.x, dy = b.y - a.y;
+        float len2 = dx * dx + dy * dy;
+        float t = len2 > 0 ? max(0.0f, min(1.0f, ((px - a.x) * dx + (py - a.y) * dy) / len2)) : 0;
+        best = min(best, hypot(a.x + t * dx - px, a.y + t * dy - py));
+    }
+    return best;
+}
+
+// Pixel-center coverage by brute force: the winding of every edge crossing the row at or left
+// of the center, with the filler's half-open [a.y, b.y) rule. Returns 1 (covered), 0, or -1
+// when a crossing is too close to the center to call.
+int centerCoverage(const vector<Vec2f>& poly, int x, int y, FillRule rule) {
+    double px = x + 0.5, py = y + 0.5;
+    int winding = 0, crossings = 0;
+    for (size_t i = 0; i < poly.size(); i++) {
+        Vec2f a = poly[i], b = poly[(i + 1) % poly.size()];
+        int dir = 1;
+        if (a.y > b.y) { swap(a, b); dir = -1; }
+        if (!(a.y <= py && py < b.y)) continue;
+        double cx = a.x + (py - a.y) * ((double)b.x - a.x) / ((double)b.y - a.y);
+        if (fabs(cx - px) < 1e-3) return -1;
+        if (cx <= px) { winding += dir; crossings++; }
+    }
+    return rule == FILL_NONZERO ? winding != 0 : (crossings & 1);
+}
+
+bool covered(const Framebuffer& fb, int x, int y) { return fb.row(y)[x] != 0; }
+
+// Fills one polygon with the edge table filler, optionally banded over a pool
+void fillOne(Framebuffer& fb, const vector<Vec2f>& poly, FillRule rule, ThreadPool* pool, int bandHeight) {
+    static ScanlineFiller edgeTable;
+    FillPolygons polys;
+    polys.addContour(poly.data(), poly.size());
+    polys.endPolygon(0xFFFFFFFFu);
+    fb.clear(0u);
+    edgeTable.fill(fb, polys, rule, pool, bandHeight);
+}
+
+// Checks the edge table filler, returning 0 when every check passes:
+//  - simple polygons against the legacy scanLineFill with both fill rules, allowing only
+//    pixels next to the boundary to differ (the legacy filler samples scanlines at integer y
+//    and truncates crossings)
+//  - self-intersecting polygons, huge coordinates and near-horizontal edges against
+//    brute-force pixel-center coverage for both rules
+//  - banded parallel fills, which enter edges part way down, against the single band
+int verifyFill() {
+    const int size = 256;
+    Framebuffer fb(size, size), banded(size, size), legacy(size, size);
+    ThreadPool pool;
+    mt19937 rng(7);
+    uniform_real_distribution<float> unit(0, 1);
+    size_t failures = 0, polygons = 0;
+
+    auto star = [&](int vertices, int turns, bool integral) {
+        float cx = size * (0.2f + 0.6f * unit(rng)), cy = size * (0.2f + 0.6f * unit(rng));
+        float r = size * (0.1f + 0.5f * unit(rng));
+        vector<Vec2f> poly(vertices);
+        for (int i = 0; i < vertices; i++) {
+            float a = 2 * 3.14159265f * turns * i / vertices, d = r * (0.5f + 0.5f * unit(rng));
+            poly[i] = {cx + d * cos(a), cy + d * sin(a)};
+            if (integral) poly[i] = {floorf(poly[i].x), floorf(poly[i].y)};
+        }
+        return poly;
+    };
+
+    auto checkCoverage = [&](const vector<Vec2f>& poly, FillRule rule) {
+        fillOne(fb, poly, rule, nullptr, 0);
+        fillOne(banded, poly, rule, &pool, 7);
+        size_t bad = 0;
+        for (int y = 0; y < size; y++) {
+            bad += memcmp(fb.row(y), banded.row(y), size * sizeof(uint32_t)) != 0;
+            for (int x = 0; x < size; x++) {
+                int expected = centerCoverage(poly, x, y, rule);
+                bad += expected >= 0 && expected != (int)covered(fb, x, y);
+            }
+        }
+        polygons++;
+        return bad;
+    };
+
+    size_t legacyFailures = 0, coverageFailures = 0;
+    for (int round = 0; round < 200; round++) {
+        vector<Vec2f> poly = star(3 + round % 40, 1, true);
+        vector<pair<int, int>> ints;
+        for (auto& v : poly) ints.push_back({(int)v.x, (int)v.y});
+        swap(framebuffer, legacy);
+        framebuffer.clear(0u);
+        framebuffer.color = 0xFFFFFFFFu;
+        scanLineFill(ints);
+        swap(framebuffer, legacy);
+
+        for (FillRule rule : {FILL_EVEN_ODD, FILL_NONZERO}) {
+            fillOne(fb, poly, rule, nullptr, 0);
+            for (int y = 0; y < size; y++)
+                for (int x = 0; x < size; x++)
+                    if (covered(fb, x, y) != covered(legacy, x, y) && boundaryDistance(poly, x + 0.5f, y + 0.5f) > 2.0f)
+                        legacyFailures++;
+            coverageFailures += checkCoverage(poly, rule);
+        }
+    }
+
+    // Self-intersecting stars, where the two rules differ
+    for (int round = 0; round < 100; round++) {
+        vector<Vec2f> poly = star(5 + round % 30, 2, false);
+        for (FillRule rule : {FILL_EVEN_ODD, FILL_NONZERO}) coverageFailures += checkCoverage(poly, rule);
+    }
+
+    // Coordinates far outside the target, and edges far flatter than 32767 px per scanline
+    vector<vector<Vec2f>> extremes = {
+        {{-1e6f, -1e6f}, {1e6f, 10}, {20, 1e6f}},
+        {{-40000, 100.49f}, {40000, 100.51f}, {128, 250}},
+        {{-3e5f, 30.2f}, {3e5f, 30.8f}, {3e5f, 200.3f}, {-3e5f, 199.7f}},
+        {{128, -5e5f}, {129, 5e5f}, {200, 5e5f}},
+        {{-1e9f, 128.5f}, {1e9f, 128.5f}, {0, 128.7f}}};
+    for (auto& poly : extremes)
+        for (FillRule rule : {FILL_EVEN_ODD, FILL_NONZERO}) coverageFailures += checkCoverage(poly, rule);
+
+    failures = legacyFailures + coverageFailures;
+    cout << polygons << " fills, " << legacyFailures << " pixels off against scanLineFill, "
+         << coverageFailures << " against pixel-center coverage\n";
+    return failures == 0 ? 0 : 1;
+}
+
 void init() {
+    vector<Vec2f> points;
+    for (auto& p : polygon) points.push_back({(float)p.first, (float)p.second});
+    fillPolygons.addContour(points.data(), points.size());
+    fillPolygons.endPolygon(Framebuffer::pack(0, 1, 0));
+
     glClearColor(1, 1, 1, 1); // White background
     gluOrtho2D(0, 500, 0, 500); // 2D coordinate system
 }
 
 int main(int argc, char** argv) {
+    // "--bench" times the fillers and "--verify" checks them, without opening a window
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return benchmarkFill();
+    if (argc > 1 && strcmp(argv[1], "--verify") == 0)
+        return verifyFill();
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(500, 500);
@@ -0,0 +1,466 @@
+/* Software triangle rasterizer with selectable visible-surface engines.
+Triangles are projected, set up as edge functions (half-space tests at pixel centers with a
+top-left fill rule) plus a depth plane, and binned into 64x64 screen tiles in parallel.
+Tiles are then rendered in parallel, each with its own depth buffer:
+
+  ENGINE_ZBUFFER  depth test per pixel; every 8x8 block keeps its farthest depth so blocks
+                  a triangle cannot reach are rejected before any pixel is touched
+                  (hierarchical Z / early rejection)
+  ENGINE_PAINTER  list priority: triangles sorted far to near and drawn without depth test
+  ENGINE_WARNOCK  area subdivision: a region is filled when one triangle surrounds it and is
+                  in front of everything else there, otherwise it is split in four down to
+                  single pixels
+
+draw() returns triangles/sec and overdraw statistics for the frame. */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "Framebuffer.h"
+#include "Instrumentation.h"
+#include "ThreadPool.h"
+#include "Transform.h"
+
+enum VisibilityEngine { ENGINE_ZBUFFER, ENGINE_PAINTER, ENGINE_WARNOCK };
+
+inline const char* engineName(VisibilityEngine engine) {
+    switch (engine) {
+        case ENGINE_ZBUFFER: return "Z-buffer";
+        case ENGINE_PAINTER: return "Painter's (list priority)";
+        default: return "Warnock (area subdivision)";
+    }
+}
+
+// Indexed triangle list with one packed RGBA color per triangle
+struct RasterMesh {
+    VertexArray3 positions;
+    std::vector<uint32_t> indices;  // 3 per triangle
+    std::vector<uint32_t> colors;   // 1 per triangle
+
+    size_t triangleCount() const { return indices.size() / 3; }
+};
+
+struct RasterStats {
+    size_t triangles = 0;       // submitted
+    size_t culled = 0;          // back-facing, degenerate, off screen or crossing the near plane
+    size_t binned = 0;          // triangle/tile pairs
+    size_t blocksRejected = 0;  // 8x8 blocks skipped by hierarchical Z
+    size_t fragments = 0;       // pixels that passed the edge tests
+    size_t pixelsWritten = 0;   // color writes
+    size_t pixelsCovered = 0;   // pixels with at least one triangle in the final image
+    double milliseconds = 0;
+
+    double trianglesPerSecond() const { return milliseconds > 0 ? triangles / (milliseconds / 1000.0) : 0; }
+    // Color writes per visible pixel; 1.0 means every pixel was shaded exactly once
+    double overdraw() const { return pixelsCovered ? (double)pixelsWritten / pixelsCovered : 0; }
+
+    RasterStats& operator+=(const RasterStats& o) {
+        triangles += o.triangles; culled += o.culled; binned += o.binned;
+        blocksRejected += o.blocksRejected; fragments += o.fragments;
+        pixelsWritten += o.pixelsWritten; pixelsCovered += o.pixelsCovered;
+        milliseconds += o.milliseconds;
+        return *this;
+    }
+};
+
+class SoftwareRasterizer {
+public:
+    static const int kTileSize = 64;
+    static const int kBlockSize = 8;
+
+    explicit SoftwareRasterizer(ThreadPool* pool = nullptr) : pool(pool) {}
+
+    bool cullBackFaces = true;
+
+    // Renders mesh transformed by mvp (model-view-projection) into fb. Color is not cleared,
+    // so the caller's background shows where nothing is drawn.
+    RasterStats draw(Framebuffer& fb, const RasterMesh& mesh, const Mat4& mvp, VisibilityEngine engine) {
+        GRAPHICS_TIMED_SCOPE("raster.draw");
+        auto t0 = std::chrono::steady_clock::now();
+        RasterStats stats;
+        stats.triangles = mesh.triangleCount();
+
+        project(mesh, mvp, fb.width, fb.height);
+        setupTriangles(mesh, fb.width, fb.height);
+        stats.culled = stats.triangles - setups.size();
+        if (engine == ENGINE_PAINTER) {
+            // Farthest first; the order survives binning
+            std::stable_sort(setups.begin(), setups.end(),
+                             [](const Setup& a, const Setup& b) { return a.maxZ > b.maxZ; });
+        }
+        binTriangles(fb.width, fb.height);
+
+        tileStats.assign(tiles.size(), RasterStats());
+        {
+            GRAPHICS_TIMED_SCOPE("raster.tiles");
+            forEach(tiles.size(), [&](size_t t) { renderTile(fb, t, engine, tileStats[t]); });
+        }
+        for (auto& s : tileStats) {
+            stats.binned += s.binned;
+            stats.blocksRejected += s.blocksRejected;
+            stats.fragments += s.fragments;
+            stats.pixelsWritten += s.pixelsWritten;
+            stats.pixelsCovered += s.pixelsCovered;
+        }
+        GRAPHICS_COUNT("raster.triangles", stats.triangles);
+        GRAPHICS_COUNT("raster.fragments", stats.fragments);
+        stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        return stats;
+    }
+
+private:
+    struct Setup {
+        float a[3], b[3], c[3];  // edge functions E = a x + b y + c, >= 0 inside
+        bool topLeft[3];
+        float za, zb, zc;        // depth plane z = za x + zb y + zc
+        float minZ, maxZ;
+        int x0, y0, x1, y1;      // inclusive pixel bounds, clamped to the target
+        uint32_t color;
+    };
+
+    struct Tile {
+        int x0, y0, x1, y1;  // pixel bounds [x0, x1) x [y0, y1)
+        float depth[kTileSize * kTileSize];
+        float blockMax[(kTileSize / kBlockSize) * (kTileSize / kBlockSize)];
+        std::vector<uint32_t> triangles;
+    };
+
+    // Screen space: x, y in pixels, z in [0, 1] (0 nearest); w <= 0 marks vertices behind
+    // the eye
+    void project(const RasterMesh& mesh, const Mat4& m, int width, int height) {
+        size_t n = mesh.positions.size();
+        screen.resize(n);
+        behind.resize(n);
+        const VertexArray3& p = mesh.positions;
+        forEachChunk(n, pool, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                float x = p.x[i], y = p.y[i], z = p.z[i];
+                float cx = m.m[0][0] * x + m.m[0][1] * y + m.m[0][2] * z + m.m[0][3];
+                float cy = m.m[1][0] * x + m.m[1][1] * y + m.m[1][2] * z + m.m[1][3];
+                float cz = m.m[2][0] * x + m.m[2][1] * y + m.m[2][2] * z + m.m[2][3];
+                float cw = m.m[3][0] * x + m.m[3][1] * y + m.m[3][2] * z + m.m[3][3];
+                behind[i] = cw <= 1e-6f || cz < -cw;
+                float inv = behind[i] ? 0 : 1.0f / cw;
+                screen.x[i] = (cx * inv * 0.5f + 0.5f) * width;
+                screen.y[i] = (cy * inv * 0.5f + 0.5f) * height;
+                screen.z[i] = cz * inv * 0.5f + 0.5f;
+            }
+        });
+    }
+
+    // Builds edge functions in parallel chunks, then compacts the survivors in order
+    void setupTriangles(const RasterMesh& mesh, int width, int height) {
+        GRAPHICS_TIMED_SCOPE("raster.setup");
+        size_t count = mesh.triangleCount();
+        allSetups.resize(count);
+        valid.assign(count, 0);
+        const size_t chunk = 4096;
+        forEach((count + chunk - 1) / chunk, [&](size_t c) {
+            for (size_t t = c * chunk; t < std::min(count, (c + 1) * chunk); t++)
+                valid[t] = setupTriangle(mesh, t, width, height, allSetups[t]);
+        });
+        setups.clear();
+        for (size_t t = 0; t < count; t++)
+            if (valid[t]) setups.push_back(allSetups[t]);
+    }
+
+    bool setupTriangle(const RasterMesh& mesh, size_t t, int width, int height, Setup& s) const {
+        uint32_t i0 = mesh.indices[t * 3], i1 = mesh.indices[t * 3 + 1], i2 = mesh.indices[t * 3 + 2];
+        if (behind[i0] || behind[i1] || behind[i2]) return false;
+        float x[3] = {screen.x[i0], screen.x[i1], screen.x[i2]};
+        float y[3] = {screen.y[i0], screen.y[i1], screen.y[i2]};
+        float z[3] = {screen.z[i0], screen.z[i1], screen.z[i2]};
+
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area == 0 || (area < 0 && cullBackFaces)) return false;
+        if (area < 0) {
+            std::swap(x[1], x[2]); std::swap(y[1], y[2]); std::swap(z[1], z[2]);
+            area = -area;
+        }
+
+        s.x0 = std::max((int)std::floor(std::min({x[0], x[1], x[2]})), 0);
+        s.y0 = std::max((int)std::floor(std::min({y[0], y[1], y[2]})), 0);
+        s.x1 = std::min((int)std::ceil(std::max({x[0], x[1], x[2]})), width - 1);
+        s.y1 = std::min((int)std::ceil(std::max({y[0], y[1], y[2]})), height - 1);
+        if (s.x0 > s.x1 || s.y0 > s.y1) return false;
+
+        for (int e = 0; e < 3; e++) {
+            int i = e, j = (e + 1) % 3;
+            s.a[e] = y[i] - y[j];
+            s.b[e] = x[j] - x[i];
+            s.c[e] = x[i] * y[j] - y[i] * x[j];
+            // Pixels exactly on an edge shared by two triangles belong to only one of them
+            s.topLeft[e] = s.a[e] > 0 || (s.a[e] == 0 && s.b[e] < 0);
+        }
+
+        // Depth plane through the three vertices
+        float inv = 1.0f / area;
+        s.za = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * inv;
+        s.zb = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * inv;
+        s.zc = z[0] - s.za * x[0] - s.zb * y[0];
+        s.minZ = std::min({z[0], z[1], z[2]});
+        s.maxZ = std::max({z[0], z[1], z[2]});
+        s.color = mesh.colors[t];
+        return true;
+    }
+
+    // Each chunk of triangles bins into its own lists; tiles then concatenate the lists in
+    // chunk order so submission (or painter) order is preserved
+    void binTriangles(int width, int height) {
+        GRAPHICS_TIMED_SCOPE("raster.bin");
+        int tilesX = (width + kTileSize - 1) / kTileSize, tilesY = (height + kTileSize - 1) / kTileSize;
+        if (tiles.size() != (size_t)tilesX * tilesY) {
+            tiles.clear();
+            tiles.resize((size_t)tilesX * tilesY);
+            warnockLists.resize(tiles.size());
+        }
+        for (int ty = 0; ty < tilesY; ty++)
+            for (int tx = 0; tx < tilesX; tx++) {
+                Tile& tile = tiles[ty * tilesX + tx];
+                tile.x0 = tx * kTileSize;
+                tile.y0 = ty * kTileSize;
+                tile.x1 = std::min(tile.x0 + kTileSize, width);
+                tile.y1 = std::min(tile.y0 + kTileSize, height);
+                tile.triangles.clear();
+            }
+
+        const size_t chunk = 8192;
+        size_t chunks = (setups.size() + chunk - 1) / chunk;
+        if (chunkBins.size() < chunks) chunkBins.resize(chunks);
+        forEach(chunks, [&](size_t c) {
+            auto& bins = chunkBins[c];
+            bins.resize(tiles.size());
+            for (auto& b : bins) b.clear();
+            for (size_t t = c * chunk; t < std::min(setups.size(), (c + 1) * chunk); t++) {
+                const Setup& s = setups[t];
+                for (int ty = s.y0 / kTileSize; ty <= s.y1 / kTileSize; ty++)
+                    for (int tx = s.x0 / kTileSize; tx <= s.x1 / kTileSize; tx++)
+                        bins[ty * tilesX + tx].push_back((uint32_t)t);
+            }
+        });
+        forEach(tiles.size(), [&](size_t t) {
+            for (size_t c = 0; c < chunks; c++)
+                tiles[t].triangles.insert(tiles[t].triangles.end(), chunkBins[c][t].begin(), chunkBins[c][t].end());
+        });
+    }
+
+    // Smallest value of the edge function over the pixel centers of [x0, x1] x [y0, y1]
+    static float edgeMin(const Setup& s, int e, int x0, int y0, int x1, int y1) {
+        float x = s.a[e] > 0 ? x0 + 0.5f : x1 + 0.5f;
+        float y = s.b[e] > 0 ? y0 + 0.5f : y1 + 0.5f;
+        return s.a[e] * x + s.b[e] * y + s.c[e];
+    }
+
+    static float edgeMax(const Setup& s, int e, int x0, int y0, int x1, int y1) {
+        float x = s.a[e] > 0 ? x1 + 0.5f : x0 + 0.5f;
+        float y = s.b[e] > 0 ? y1 + 0.5f : y0 + 0.5f;
+        return s.a[e] * x + s.b[e] * y + s.c[e];
+    }
+
+    static bool insideEdge(const Setup& s, int e, float value) {
+        return value > 0 || (value == 0 && s.topLeft[e]);
+    }
+
+    void renderTile(Framebuffer& fb, size_t index, VisibilityEngine engine, RasterStats& stats) {
+        Tile& tile = tiles[index];
+        std::fill(std::begin(tile.depth), std::end(tile.depth), std::numeric_limits<float>::infinity());
+        std::fill(std::begin(tile.blockMax), std::end(tile.blockMax), std::numeric_limits<float>::infinity());
+        stats.binned = tile.triangles.size();
+
+        if (engine == ENGINE_WARNOCK) {
+            std::vector<uint32_t>& scratch = warnockLists[index];
+            scratch.assign(tile.triangles.begin(), tile.triangles.end());
+            subdivide(fb, tile, tile.x0, tile.y0, kTileSize, 0, scratch.size(), scratch, stats);
+        } else {
+            for (uint32_t t : tile.triangles) rasterizeInTile(fb, tile, setups[t], engine == ENGINE_ZBUFFER, stats);
+        }
+
+        for (int y = tile.y0; y < tile.y1; y++)
+            for (int x = tile.x0; x < tile.x1; x++)
+                stats.pixelsCovered += tile.depth[(y - tile.y0) * kTileSize + (x - tile.x0)] != std::numeric_limits<float>::infinity();
+    }
+
+    void rasterizeInTile(Framebuffer& fb, Tile& tile, const Setup& s, bool depthTest, RasterStats& stats) {
+        int bx0 = std::max(s.x0, tile.x0), by0 = std::max(s.y0, tile.y0);
+        int bx1 = std::min(s.x1, tile.x1 - 1), by1 = std::min(s.y1, tile.y1 - 1);
+        const int blocksPerRow = kTileSize / kBlockSize;
+
+        for (int blockY = (by0 - tile.y0) / kBlockSize; blockY <= (by1 - tile.y0) / kBlockSize; blockY++) {
+            for (int blockX = (bx0 - tile.x0) / kBlockSize; blockX <= (bx1 - tile.x0) / kBlockSize; blockX++) {
+                int px0 = std::max(tile.x0 + blockX * kBlockSize, bx0), py0 = std::max(tile.y0 + blockY * kBlockSize, by0);
+                int px1 = std::min(tile.x0 + (blockX + 1) * kBlockSize - 1, bx1);
+                int py1 = std::min(tile.y0 + (blockY + 1) * kBlockSize - 1, by1);
+                float& blockMax = tile.blockMax[blockY * blocksPerRow + blockX];
+
+                // Hierarchical Z: nothing in this triangle can be nearer than the block
+                if (depthTest && s.minZ >= blockMax) {
+                    stats.blocksRejected++;
+                    continue;
+                }
+                // Trivially outside one edge, or inside all three
+                bool full = true, outside = false;
+                for (int e = 0; e < 3; e++) {
+                    if (edgeMax(s, e, px0, py0, px1, py1) < 0) outside = true;
+                    if (edgeMin(s, e, px0, py0, px1, py1) <= 0) full = false;
+                }
+                if (outside) continue;
+
+                bool wrote = false;
+                for (int y = py0; y <= py1; y++) {
+                    float cy = y + 0.5f;
+                    float cx = px0 + 0.5f;
+                    float e0 = s.a[0] * cx + s.b[0] * cy + s.c[0];
+                    float e1 = s.a[1] * cx + s.b[1] * cy + s.c[1];
+                    float e2 = s.a[2] * cx + s.b[2] * cy + s.c[2];
+                    float z = s.za * cx + s.zb * cy + s.zc;
+                    float* depthRow = tile.depth + (y - tile.y0) * kTileSize - tile.x0;
+                    uint32_t* colorRow = fb.row(y);
+                    for (int x = px0; x <= px1; x++, e0 += s.a[0], e1 += s.a[1], e2 += s.a[2], z += s.za) {
+                        if (!full && !(insideEdge(s, 0, e0) && insideEdge(s, 1, e1) && insideEdge(s, 2, e2)))
+                            continue;
+                        stats.fragments++;
+                        if (depthTest && z >= depthRow[x]) continue;
+                        depthRow[x] = z;
+                        colorRow[x] = s.color;
+                        stats.pixelsWritten++;
+                        wrote = true;
+                    }
+                }
+                if (depthTest && wrote) blockMax = farthestInBlock(tile, blockX, blockY);
+            }
+        }
+    }
+
+    static float farthestInBlock(const Tile& tile, int blockX, int blockY) {
+        float m = 0;
+        for (int y = 0; y < kBlockSize; y++) {
+            const float* row = tile.depth + (blockY * kBlockSize + y) * kTileSize + blockX * kBlockSize;
+            for (int x = 0; x < kBlockSize; x++) m = std::max(m, row[x]);
+        }
+        return m;
+    }
+
+    // Warnock's algorithm on the square region at (x0, y0); candidates are
+    // list[begin, end), and children append their own lists after end
+    void subdivide(Framebuffer& fb, Tile& tile, int x0, int y0, int size, size_t begin, size_t end,
+                   std::vector<uint32_t>& list, RasterStats& stats) {
+        int x1 = std::min(x0 + size, tile.x1) - 1, y1 = std::min(y0 + size, tile.y1) - 1;
+        if (x0 > x1 || y0 > y1) return;
+
+        // Keep the triangles that overlap this region
+        size_t first = list.size();
+        for (size_t i = begin; i < end; i++) {
+            const Setup& s = setups[list[i]];
+            if (s.x1 < x0 || s.x0 > x1 || s.y1 < y0 || s.y0 > y1) continue;
+            bool disjoint = false;
+            for (int e = 0; e < 3 && !disjoint; e++) disjoint = edgeMax(s, e, x0, y0, x1, y1) < 0;
+            if (!disjoint) list.push_back(list[i]);
+        }
+        size_t last = list.size();
+
+        if (first == last) return;
+        if (x0 == x1 && y0 == y1) {
+            resolvePixel(fb, tile, x0, y0, first, last, list, stats);
+        } else if (!fillIfSurrounded(fb, tile, x0, y0, x1, y1, first, last, list, stats)) {
+            int half = size / 2;
+            subdivide(fb, tile, x0, y0, half, first, last, list, stats);
+            subdivide(fb, tile, x0 + half, y0, half, first, last, list, stats);
+            subdivide(fb, tile, x0, y0 + half, half, first, last, list, stats);
+            subdivide(fb, tile, x0 + half, y0 + half, half, first, last, list, stats);
+        }
+        list.resize(first);
+    }
+
+    // Depth range of a triangle's plane over the region corners, clamped to the triangle
+    static void depthRange(const Setup& s, int x0, int y0, int x1, int y1, float& lo, float& hi) {
+        float corners[4] = {
+            s.za * (x0 + 0.5f) + s.zb * (y0 + 0.5f) + s.zc, s.za * (x1 + 0.5f) + s.zb * (y0 + 0.5f) + s.zc,
+            s.za * (x0 + 0.5f) + s.zb * (y1 + 0.5f) + s.zc, s.za * (x1 + 0.5f) + s.zb * (y1 + 0.5f) + s.zc};
+        lo = std::max(std::min({corners[0], corners[1], corners[2], corners[3]}), s.minZ);
+        hi = std::min(std::max({corners[0], corners[1], corners[2], corners[3]}), s.maxZ);
+    }
+
+    bool fillIfSurrounded(Framebuffer& fb, Tile& tile, int x0, int y0, int x1, int y1, size_t first, size_t last,
+                          const std::vector<uint32_t>& list, RasterStats& stats) {
+        // The nearest surrounding triangle must be in front of every other candidate
+        int best = -1;
+        float bestFar = std::numeric_limits<float>::infinity();
+        for (size_t i = first; i < last; i++) {
+            const Setup& s = setups[list[i]];
+            bool surrounds = true;
+            for (int e = 0; e < 3 && surrounds; e++) surrounds = edgeMin(s, e, x0, y0, x1, y1) > 0;
+            if (!surrounds) continue;
+            float lo, hi;
+            depthRange(s, x0, y0, x1, y1, lo, hi);
+            if (hi < bestFar) {
+                bestFar = hi;
+                best = (int)i;
+            }
+        }
+        if (best < 0) return false;
+        for (size_t i = first; i < last; i++) {
+            if ((int)i == best) continue;
+            float lo, hi;
+            depthRange(setups[list[i]], x0, y0, x1, y1, lo, hi);
+            if (lo < bestFar) return false;
+        }
+
+        const Setup& s = setups[list[best]];
+        for (int y = y0; y <= y1; y++) {
+            std::fill(fb.row(y) + x0, fb.row(y) + x1 + 1, s.color);
+            for (int x = x0; x <= x1; x++)
+                tile.depth[(y - tile.y0) * kTileSize + (x - tile.x0)] = s.za * (x + 0.5f) + s.zb * (y + 0.5f) + s.zc;
+        }
+        size_t pixels = (size_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+        stats.fragments += pixels;
+        stats.pixelsWritten += pixels;
+        return true;
+    }
+
+    void resolvePixel(Framebuffer& fb, Tile& tile, int x, int y, size_t first, size_t last,
+                      const std::vector<uint32_t>& list, RasterStats& stats) {
+        float cx = x + 0.5f, cy = y + 0.5f;
+        float nearest = std::numeric_limits<float>::infinity();
+        uint32_t color = 0;
+        for (size_t i = first; i < last; i++) {
+            const Setup& s = setups[list[i]];
+            bool inside = true;
+            for (int e = 0; e < 3 && inside; e++) inside = insideEdge(s, e, s.a[e] * cx + s.b[e] * cy + s.c[e]);
+            if (!inside) continue;
+            stats.fragments++;
+            float z = s.za * cx + s.zb * cy + s.zc;
+            if (z < nearest) {
+                nearest = z;
+                color = s.color;
+            }
+        }
+        if (nearest == std::numeric_limits<float>::infinity()) return;
+        fb.row(y)[x] = color;
+        tile.depth[(y - tile.y0) * kTileSize + (x - tile.x0)] = nearest;
+        stats.pixelsWritten++;
+    }
+
+    // std::cref keeps the std::function from copying (and allocating for) the lambda
+    template <class Fn>
+    void forEach(size_t count, const Fn& fn) {
+        if (pool) pool->parallelFor(count, std::cref(fn));
+        else for (size_t i = 0; i < count; i++) fn(i);
+    }
+
+    ThreadPool* pool;
+    VertexArray3 screen;
+    std::vector<uint8_t> behind, valid;
+    std::vector<Setup> allSetups, setups;
+    std::vector<Tile> tiles;
+    std::vector<std::vector<std::vector<uint32_t>>> chunkBins;
+    std::vector<RasterStats> tileStats;
+    std::vector<std::vector<uint32_t>> warnockLists;  // per tile, so tiles subdivide concurrently
+};
@@ -4,6 +4,9 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <cstring>
+#include <random>
+#include "PolygonClip.h"
 
 using namespace std;
 
@@ -11,73 +14,85 @@ using namespace std;
 const int xmin = 100, ymin = 100, xmax = 400, ymax = 400;
 
 // Define the polygon vertices (x, y)
-vector<pair<int, int>> polygon = {
+vector<Vec2f> polygon = {
     {50, 50}, {450, 50}, {450, 450}, {50, 450}
 };
 
-// Function to plot a polygon
-void plotPolygon(const vector<pair<int, int>>& poly) {
+// Function to plot a polygon (the original vector or a clipped view)
+template <class Polygon>
+void plotPolygon(const Polygon& poly) {
     glBegin(GL_LINE_LOOP);
     for (auto& vertex : poly) {
-        glVertex2i(vertex.first, vertex.second);
+        glVertex2f(vertex.x, vertex.y);
     }
     glEnd();
 }
 
-// Function to compute the cross product of two vectors (p1 -> p2) x (p2 -> p3)
-int crossProduct(pair<int, int> p1, pair<int, int> p2, pair<int, int> p3) {
-    return (p2.first - p1.first) * (p3.second - p1.second) -
-           (p2.second - p1.second) * (p3.first - p1.first);
+// Clipping window and scratch buffers, reused every frame so clipping never allocates
+ConvexClipWindow clipWindow = ConvexClipWindow::rectangle(xmin, ymin, xmax, ymax);
+PolygonClipArena clipArena;
+
+// Function to clip the polygon against all four edges of the clipping window
+ClippedPolygon sutherlandHodgmanClip(const vector<Vec2f>& polygon) {
+    return clipPolygon(polygon.data(), polygon.size(), clipWindow, clipArena);
 }
 
-// Function to clip the polygon against one edge of the clipping window
-vector<pair<int, int>> clipEdge(vector<pair<int, int>> subjectPolygon, pair<int, int> clipStart, pair<int, int> clipEnd) {
-    vector<pair<int, int>> outputPolygon;
-    
-    // Loop through each edge of the polygon
-    int n = subjectPolygon.size();
-    for (int i = 0; i < n; i++) {
-        pair<int, int> currentPoint = subjectPolygon[i];
-        pair<int, int> previousPoint = subjectPolygon[(i + n - 1) % n];
-
-        // Calculate the cross product to check if the point is inside or outside the clipping edge
-        int crossPrev = crossProduct(clipStart, clipEnd, previousPoint);
-        int crossCurr = crossProduct(clipStart, clipEnd, currentPoint);
-
-        // Case 1: If the current point is inside the clipping window (cross product >= 0)
-        if (crossCurr >= 0) {
-            // If the previous point is outside, compute the intersection point
-            if (crossPrev < 0) {
-                float t = (float)crossProduct(previousPoint, currentPoint, clipStart) / (crossProduct(previousPoint, currentPoint, clipEnd) - crossProduct(previousPoint, currentPoint, clipStart));
-                int x = previousPoint.first + t * (currentPoint.first - previousPoint.first);
-                int y = previousPoint.second + t * (currentPoint.second - previousPoint.second);
-                outputPolygon.push_back({x, y});
+// ==== Verification ====
+
+// Straightforward Sutherland-Hodgman that allocates a new vector for every edge
+vector<Vec2f> referenceClip(vector<Vec2f> poly, const ConvexClipWindow& window) {
+    for (int e = 0; e < window.count && !poly.empty(); e++) {
+        const ClipHalfPlane& plane = window.planes[e];
+        vector<Vec2f> out;
+        for (size_t i = 0; i < poly.size(); i++) {
+            Vec2f prev = poly[(i + poly.size() - 1) % poly.size()], curr = poly[i];
+            float dPrev = plane.distance(prev), dCurr = plane.distance(curr);
+            if ((dPrev >= 0) != (dCurr >= 0)) {
+                float t = dPrev / (dPrev - dCurr);
+                out.push_back({prev.x + t * (curr.x - prev.x), prev.y + t * (curr.y - prev.y)});
             }
-            outputPolygon.push_back(currentPoint);
-        } else if (crossPrev >= 0) {
-            // Case 2: If the previous point is inside, compute the intersection point
-            float t = (float)crossProduct(previousPoint, currentPoint, clipStart) / (crossProduct(previousPoint, currentPoint, clipEnd) - crossProduct(previousPoint, currentPoint, clipStart));
-            int x = previousPoint.first + t * (currentPoint.first - previousPoint.first);
-            int y = previousPoint.second + t * (currentPoint.second - previousPoint.second);
-            outputPolygon.push_back({x, y});
+            if (dCurr >= 0) out.push_back(curr);
         }
+        poly = out;
     }
+    return poly;
+}
 
-    return outputPolygon;
+// Comb with the given number of teeth; each tooth pokes out through the top and bottom of
+// the window, so every pass nearly doubles the vertex count
+vector<Vec2f> combPolygon(int teeth, mt19937& rng) {
+    uniform_real_distribution<float> jitter(-5.0f, 5.0f);
+    float width = float(xmax - xmin) / teeth;
+    vector<Vec2f> comb;
+    for (int i = 0; i < teeth; i++) {
+        float x = xmin + i * width;
+        comb.push_back({x + jitter(rng), ymin - 50 + jitter(rng)});
+        comb.push_back({x + width * 0.5f + jitter(rng), ymax + 50 + jitter(rng)});
+    }
+    comb.push_back({xmax + 50.0f, ymin - 80.0f});
+    return comb;
 }
 
-// Function to clip the polygon against all four edges of the clipping window
-vector<pair<int, int>> sutherlandHodgmanClip(vector<pair<int, int>> polygon) {
-    // Clip against left edge
-    polygon = clipEdge(polygon, {xmin, ymin}, {xmin, ymax});
-    // Clip against right edge
-    polygon = clipEdge(polygon, {xmax, ymin}, {xmax, ymax});
-    // Clip against bottom edge
-    polygon = clipEdge(polygon, {xmin, ymin}, {xmax, ymin});
-    // Clip against top edge
-    polygon = clipEdge(polygon, {xmin, ymax}, {xmax, ymax});
-    
-    return polygon;
+// Checks clipPolygon against referenceClip on concave combs; returns 0 when all match
+int verifyPolygonClipper() {
+    mt19937 rng(12345);
+    size_t mismatches = 0, polygons = 0;
+    for (int teeth = 1; teeth <= 200; teeth++) {
+        for (int round = 0; round < 4; round++) {
+            vector<Vec2f> comb = combPolygon(teeth, rng);
+            // Fresh arena each time so the first-use growth is exercised
+            PolygonClipArena arena;
+            ClippedPolygon clipped = clipPolygon(comb.data(), comb.size(), clipWindow, arena);
+            vector<Vec2f> expected = referenceClip(comb, clipWindow);
+            polygons++;
+            bool same = clipped.size == expected.size();
+            for (size_t i = 0; same && i < expected.size(); i++)
+                same = clipped[i].x == expected[i].x && clipped[i].y == expected[i].y;
+            mismatches += !same;
+        }
+    }
+    cout << polygons << " concave polygons, " << mismatches << " mismatches\n";
+    return mismatches == 0 ? 0 : 1;
 }
 
 void display() {
@@ -97,7 +112,7 @@ void display() {
     plotPolygon(polygon);
 
     // Clip the polygon using the Sutherland-Hodgman algorithm
-    vector<pair<int, int>> clippedPolygon = sutherlandHodgmanClip(polygon);
+    ClippedPolygon clippedPolygon = sutherlandHodgmanClip(polygon);
 
     // Draw the clipped polygon (green)
     glColor3f(0, 1, 0); // Green for clipped polygon
@@ -112,6 +127,10 @@ void init() {
 }
 
 int main(int argc, char** argv) {
+    // "--verify" checks the arena clipper on concave polygons without opening a window
+    if (argc > 1 && strcmp(argv[1], "--verify") == 0)
+        return verifyPolygonClipper();
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(500, 500);
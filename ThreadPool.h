@@ -0,0 +1,193 @@
+/* ThreadPool: fixed set of worker threads for data-parallel loops and independent tasks.
+parallelFor hands out indices from a shared counter; the calling thread works too and the
+call returns once every index has been processed. Only one parallelFor may run at a time.
+
+submit queues a task without waiting. Each worker owns a task deque: submitted tasks are
+dealt round-robin onto the deques, a worker takes from the front of its own, and a worker
+whose deque is empty steals from the back of another's. wait blocks until every submitted
+task has finished. */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads == 0 uses one thread per hardware core (counting the caller)
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < threads; i++) queues.emplace_back(new TaskQueue);
+        for (unsigned i = 1; i < threads; i++)
+            workers.emplace_back([this, i] { workerLoop(i - 1); });
+    }
+
+    // Queued tasks are finished before the workers exit
+    ~ThreadPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads that run parallelFor bodies, including the caller
+    size_t size() const { return workers.size() + 1; }
+
+    // Calls fn(i) for every i in [0, count) and waits for all of them
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+        if (count == 0) return;
+        if (workers.empty() || count == 1) {
+            for (size_t i = 0; i < count; i++) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobSize = count;
+            next = 0;
+            pending = count;
+            generation++;
+        }
+        wake.notify_all();
+        runJob(fn, count);
+
+        // Also wait for workers to leave runJob so none can pick up the next job's indices
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return pending == 0 && active == 0; });
+        job = nullptr;
+    }
+
+    // Runs task on a worker; without workers it runs here before submit returns
+    void submit(std::function<void()> task) {
+        if (workers.empty()) {
+            task();
+            return;
+        }
+        unfinishedTasks++;
+        TaskQueue& queue = *queues[nextQueue++ % queues.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+            queuedTasks++;
+        }
+        // Taking the lock orders this with a worker's predicate check, so no wakeup is lost
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        wake.notify_one();
+    }
+
+    // Waits until every submitted task has finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return unfinishedTasks == 0; });
+    }
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // Own deque first, then steal from the other end of the others'
+    bool takeTask(size_t self, std::function<void()>& task) {
+        for (size_t k = 0; k < queues.size(); k++) {
+            TaskQueue& queue = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (k == 0) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            } else {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            queuedTasks--;
+            return true;
+        }
+        return false;
+    }
+
+    void runTasks(size_t self) {
+        std::function<void()> task;
+        while (takeTask(self, task)) {
+            task();
+            task = nullptr;
+            if (unfinishedTasks.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+
+    void runJob(const std::function<void(size_t)>& fn, size_t count) {
+        size_t done = 0;
+        for (size_t i; (i = next.fetch_add(1)) < count; done++) fn(i);
+        if (done && pending.fetch_sub(done) == done) {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.notify_all();
+        }
+    }
+
+    void workerLoop(size_t self) {
+        size_t seen = 0;
+        while (true) {
+            const std::function<void(size_t)>* fn;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || (generation != seen && job) || queuedTasks > 0; });
+                if (!(generation != seen && job)) {
+                    // Another worker may have taken the task that woke this one: takeTask
+                    // changes queuedTasks under the deque lock, not this mutex. Only exit
+                    // when stopping; otherwise go back to waiting.
+                    if (queuedTasks == 0) {
+                        if (stopping) return;
+                        continue;
+                    }
+                    lock.unlock();
+                    runTasks(self);
+                    continue;
+                }
+                seen = generation;
+                fn = job;
+                count = jobSize;
+                active++;
+            }
+            runJob(*fn, count);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--active == 0) finished.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<TaskQueue>> queues;  // one per worker
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> queuedTasks{0};      // in some deque, changed under that deque's lock
+    std::atomic<size_t> unfinishedTasks{0};  // queued or running
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobSize = 0;
+    size_t generation = 0;
+    size_t active = 0;  // workers inside runJob, guarded by mutex
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> pending{0};
+    bool stopping = false;
+};
@@ -0,0 +1,271 @@
+/* Transform: composed 2D (3x3) and 3D (4x4) transformation matrices and batched vertex
+transforms. A TransformStack folds every translate/scale/rotate/shear into one matrix, the
+same way OpenGL's matrix stack does (each new operation applies to the vertices first).
+Vertex arrays are stored as structures of arrays and transformed in one pass, 8 (AVX) or
+4 (SSE) vertices at a time, optionally split across a ThreadPool. The source array is never
+modified, so re-transforming it every frame cannot drift. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+#include "Instrumentation.h"
+#include "ThreadPool.h"
+
+// ==== Matrices ====
+
+// Row-major 3x3 for homogeneous 2D points: x' = m[0][0] x + m[0][1] y + m[0][2]
+struct Mat3 {
+    float m[3][3];
+
+    static Mat3 identity() { return {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}}; }
+    static Mat3 translation(float tx, float ty) { return {{{1, 0, tx}, {0, 1, ty}, {0, 0, 1}}}; }
+    static Mat3 scaling(float sx, float sy) { return {{{sx, 0, 0}, {0, sy, 0}, {0, 0, 1}}}; }
+    static Mat3 shearing(float shx, float shy) { return {{{1, shx, 0}, {shy, 1, 0}, {0, 0, 1}}}; }
+    static Mat3 rotation(float radians) {
+        float c = std::cos(radians), s = std::sin(radians);
+        return {{{c, -s, 0}, {s, c, 0}, {0, 0, 1}}};
+    }
+
+    Mat3 operator*(const Mat3& b) const {
+        Mat3 r;
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                r.m[i][j] = m[i][0] * b.m[0][j] + m[i][1] * b.m[1][j] + m[i][2] * b.m[2][j];
+        return r;
+    }
+};
+
+// Row-major 4x4 for homogeneous 3D points
+struct Mat4 {
+    float m[4][4];
+
+    static Mat4 identity() { return {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}}; }
+    static Mat4 translation(float tx, float ty, float tz) {
+        return {{{1, 0, 0, tx}, {0, 1, 0, ty}, {0, 0, 1, tz}, {0, 0, 0, 1}}};
+    }
+    static Mat4 scaling(float sx, float sy, float sz) {
+        return {{{sx, 0, 0, 0}, {0, sy, 0, 0}, {0, 0, sz, 0}, {0, 0, 0, 1}}};
+    }
+    static Mat4 rotationX(float radians) {
+        float c = std::cos(radians), s = std::sin(radians);
+        return {{{1, 0, 0, 0}, {0, c, -s, 0}, {0, s, c, 0}, {0, 0, 0, 1}}};
+    }
+    static Mat4 rotationY(float radians) {
+        float c = std::cos(radians), s = std::sin(radians);
+        return {{{c, 0, s, 0}, {0, 1, 0, 0}, {-s, 0, c, 0}, {0, 0, 0, 1}}};
+    }
+    static Mat4 rotationZ(float radians) {
+        float c = std::cos(radians), s = std::sin(radians);
+        return {{{c, -s, 0, 0}, {s, c, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+    }
+
+    // Same matrix gluPerspective builds
+    static Mat4 perspective(float fovyDegrees, float aspect, float zNear, float zFar) {
+        float f = 1.0f / std::tan(fovyDegrees * 3.14159265358979f / 360.0f);
+        float d = zNear - zFar;
+        return {{{f / aspect, 0, 0, 0}, {0, f, 0, 0}, {0, 0, (zFar + zNear) / d, 2 * zFar * zNear / d}, {0, 0, -1, 0}}};
+    }
+
+    // Same matrix glOrtho builds
+    static Mat4 orthographic(float left, float right, float bottom, float top, float zNear, float zFar) {
+        return {{{2 / (right - left), 0, 0, -(right + left) / (right - left)},
+                 {0, 2 / (top - bottom), 0, -(top + bottom) / (top - bottom)},
+                 {0, 0, -2 / (zFar - zNear), -(zFar + zNear) / (zFar - zNear)},
+                 {0, 0, 0, 1}}};
+    }
+
+    // Same matrix gluLookAt builds
+    static Mat4 lookAt(float eyeX, float eyeY, float eyeZ, float centerX, float centerY, float centerZ,
+                       float upX, float upY, float upZ) {
+        float f[3] = {centerX - eyeX, centerY - eyeY, centerZ - eyeZ};
+        normalize(f);
+        float up[3] = {upX, upY, upZ};
+        float s[3] = {f[1] * up[2] - f[2] * up[1], f[2] * up[0] - f[0] * up[2], f[0] * up[1] - f[1] * up[0]};
+        normalize(s);
+        float u[3] = {s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0]};
+        Mat4 r = {{{s[0], s[1], s[2], 0}, {u[0], u[1], u[2], 0}, {-f[0], -f[1], -f[2], 0}, {0, 0, 0, 1}}};
+        return r * translation(-eyeX, -eyeY, -eyeZ);
+    }
+
+    Mat4 operator*(const Mat4& b) const {
+        Mat4 r;
+        for (int i = 0; i < 4; i++)
+            for (int j = 0; j < 4; j++)
+                r.m[i][j] = m[i][0] * b.m[0][j] + m[i][1] * b.m[1][j] + m[i][2] * b.m[2][j] + m[i][3] * b.m[3][j];
+        return r;
+    }
+
+private:
+    static void normalize(float* v) {
+        float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (len > 0) { v[0] /= len; v[1] /= len; v[2] /= len; }
+    }
+};
+
+inline float degreesToRadians(float degrees) { return degrees * 3.14159265358979f / 180.0f; }
+
+// ==== Transform Stacks ====
+
+// Each call post-multiplies, so the operation issued last is applied to the vertices first
+template <class M>
+class TransformStack {
+public:
+    void loadIdentity() { current = M::identity(); }
+    void push() { saved.push_back(current); }
+    void pop() {
+        current = saved.back();
+        saved.pop_back();
+    }
+    void multiply(const M& op) { current = current * op; }
+    const M& matrix() const { return current; }
+
+protected:
+    M current = M::identity();
+    std::vector<M> saved;
+};
+
+class TransformStack2D : public TransformStack<Mat3> {
+public:
+    void translate(float tx, float ty) { multiply(Mat3::translation(tx, ty)); }
+    void scale(float sx, float sy) { multiply(Mat3::scaling(sx, sy)); }
+    void rotate(float radians) { multiply(Mat3::rotation(radians)); }
+    void shear(float shx, float shy) { multiply(Mat3::shearing(shx, shy)); }
+};
+
+class TransformStack3D : public TransformStack<Mat4> {
+public:
+    void translate(float tx, float ty, float tz) { multiply(Mat4::translation(tx, ty, tz)); }
+    void scale(float sx, float sy, float sz) { multiply(Mat4::scaling(sx, sy, sz)); }
+    void rotateX(float radians) { multiply(Mat4::rotationX(radians)); }
+    void rotateY(float radians) { multiply(Mat4::rotationY(radians)); }
+    void rotateZ(float radians) { multiply(Mat4::rotationZ(radians)); }
+};
+
+// ==== Vertex Arrays ====
+
+struct VertexArray2 {
+    std::vector<float> x, y;
+
+    size_t size() const { return x.size(); }
+    void resize(size_t n) { x.resize(n); y.resize(n); }
+    void push_back(float px, float py) { x.push_back(px); y.push_back(py); }
+};
+
+struct VertexArray3 {
+    std::vector<float> x, y, z;
+
+    size_t size() const { return x.size(); }
+    void resize(size_t n) { x.resize(n); y.resize(n); z.resize(n); }
+    void push_back(float px, float py, float pz) { x.push_back(px); y.push_back(py); z.push_back(pz); }
+};
+
+// ==== Batched Transforms ====
+
+// out = m * (x, y, 1) for vertices [begin, end)
+inline void transformRange(const Mat3& m, const float* x, const float* y, float* ox, float* oy,
+                           size_t begin, size_t end) {
+    size_t i = begin;
+#if defined(__AVX__)
+    const __m256 m00 = _mm256_set1_ps(m.m[0][0]), m01 = _mm256_set1_ps(m.m[0][1]), m02 = _mm256_set1_ps(m.m[0][2]);
+    const __m256 m10 = _mm256_set1_ps(m.m[1][0]), m11 = _mm256_set1_ps(m.m[1][1]), m12 = _mm256_set1_ps(m.m[1][2]);
+    for (; i + 8 <= end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i);
+        _mm256_storeu_ps(ox + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, vx), _mm256_mul_ps(m01, vy)), m02));
+        _mm256_storeu_ps(oy + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m10, vx), _mm256_mul_ps(m11, vy)), m12));
+    }
+#elif defined(__SSE__)
+    const __m128 m00 = _mm_set1_ps(m.m[0][0]), m01 = _mm_set1_ps(m.m[0][1]), m02 = _mm_set1_ps(m.m[0][2]);
+    const __m128 m10 = _mm_set1_ps(m.m[1][0]), m11 = _mm_set1_ps(m.m[1][1]), m12 = _mm_set1_ps(m.m[1][2]);
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i);
+        _mm_storeu_ps(ox + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, vx), _mm_mul_ps(m01, vy)), m02));
+        _mm_storeu_ps(oy + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, vx), _mm_mul_ps(m11, vy)), m12));
+    }
+#endif
+    for (; i < end; i++) {
+        float px = x[i], py = y[i];
+        ox[i] = m.m[0][0] * px + m.m[0][1] * py + m.m[0][2];
+        oy[i] = m.m[1][0] * px + m.m[1][1] * py + m.m[1][2];
+    }
+}
+
+// out = m * (x, y, z, 1) for vertices [begin, end); the matrix is treated as affine
+inline void transformRange(const Mat4& m, const float* x, const float* y, const float* z,
+                           float* ox, float* oy, float* oz, size_t begin, size_t end) {
+    size_t i = begin;
+#if defined(__AVX__)
+    __m256 r[3][4];
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 4; col++) r[row][col] = _mm256_set1_ps(m.m[row][col]);
+    float* out[3] = {ox, oy, oz};
+    for (; i + 8 <= end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+        for (int row = 0; row < 3; row++) {
+            __m256 v = _mm256_add_ps(_mm256_mul_ps(r[row][0], vx), _mm256_mul_ps(r[row][1], vy));
+            v = _mm256_add_ps(v, _mm256_add_ps(_mm256_mul_ps(r[row][2], vz), r[row][3]));
+            _mm256_storeu_ps(out[row] + i, v);
+        }
+    }
+#elif defined(__SSE__)
+    __m128 r[3][4];
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 4; col++) r[row][col] = _mm_set1_ps(m.m[row][col]);
+    float* out[3] = {ox, oy, oz};
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        for (int row = 0; row < 3; row++) {
+            __m128 v = _mm_add_ps(_mm_mul_ps(r[row][0], vx), _mm_mul_ps(r[row][1], vy));
+            v = _mm_add_ps(v, _mm_add_ps(_mm_mul_ps(r[row][2], vz), r[row][3]));
+            _mm_storeu_ps(out[row] + i, v);
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        float px = x[i], py = y[i], pz = z[i];
+        ox[i] = m.m[0][0] * px + m.m[0][1] * py + m.m[0][2] * pz + m.m[0][3];
+        oy[i] = m.m[1][0] * px + m.m[1][1] * py + m.m[1][2] * pz + m.m[1][3];
+        oz[i] = m.m[2][0] * px + m.m[2][1] * py + m.m[2][2] * pz + m.m[2][3];
+    }
+}
+
+// Vertices per parallelFor task; small arrays stay on the calling thread
+const size_t kTransformChunk = 1 << 16;
+
+// A template rather than std::function so the single-chunk path never allocates
+template <class Fn>
+void forEachChunk(size_t n, ThreadPool* pool, const Fn& fn) {
+    size_t chunks = (n + kTransformChunk - 1) / kTransformChunk;
+    if (!pool || chunks <= 1) {
+        fn(0, n);
+        return;
+    }
+    pool->parallelFor(chunks, [&](size_t c) { fn(c * kTransformChunk, std::min(n, (c + 1) * kTransformChunk)); });
+}
+
+// Transforms every vertex of in into out (resized to match); in is left untouched
+inline void transformVertices(const Mat3& m, const VertexArray2& in, VertexArray2& out, ThreadPool* pool = nullptr) {
+    GRAPHICS_TIMED_SCOPE("transform.2d");
+    GRAPHICS_COUNT("transform.2d.vertices", in.size());
+    out.resize(in.size());
+    forEachChunk(in.size(), pool, [&](size_t begin, size_t end) {
+        transformRange(m, in.x.data(), in.y.data(), out.x.data(), out.y.data(), begin, end);
+    });
+}
+
+inline void transformVertices(const Mat4& m, const VertexArray3& in, VertexArray3& out, ThreadPool* pool = nullptr) {
+    GRAPHICS_TIMED_SCOPE("transform.3d");
+    GRAPHICS_COUNT("transform.3d.vertices", in.size());
+    out.resize(in.size());
+    forEachChunk(in.size(), pool, [&](size_t begin, size_t end) {
+        transformRange(m, in.x.data(), in.y.data(), in.z.data(), out.x.data(), out.y.data(), out.z.data(), begin, end);
+    });
+}
@@ -4,18 +4,20 @@ Transformations (Projections- Parallel and Perspective), Vanishing points. */
 #include <GL/glut.h>
 #include <cmath>
 #include <iostream>
+#include "OfflineRenderer.h"
+#include "RasterPrimitives.h"
+#include "Transform.h"
 using namespace std;
 
-// 3D point structure
-struct Point3D {
-    float x, y, z;
+// Cube vertices (x, y and z of vertices 0-7): 0-3 back face, 4-7 front face
+VertexArray3 cube = {
+    {-1, 1, 1, -1, -1, 1, 1, -1},
+    {-1, -1, 1, 1, -1, -1, 1, 1},
+    {-1, -1, -1, -1, 1, 1, 1, 1}
 };
 
-// Cube vertices
-Point3D cube[] = {
-    {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},   // back face
-    {-1, -1, 1},  {1, -1, 1},  {1, 1, 1},  {-1, 1, 1}     // front face
-};
+// Cube after the current transformation; the original is never modified
+VertexArray3 transformed;
 
 // Transformation parameters
 float angleX = 0, angleY = 0, angleZ = 0;
@@ -26,57 +28,80 @@ bool usePerspective = true;
 
 // ==== Apply 3D Transformations ====
 
-void applyTransform(Point3D& p) {
-    // Scale
-    p.x *= scale; p.y *= scale; p.z *= scale;
-
-    // Rotate X
-    float y1 = p.y * cos(angleX) - p.z * sin(angleX);
-    float z1 = p.y * sin(angleX) + p.z * cos(angleX);
-    p.y = y1; p.z = z1;
-
-    // Rotate Y
-    float x2 = p.x * cos(angleY) + p.z * sin(angleY);
-    float z2 = -p.x * sin(angleY) + p.z * cos(angleY);
-    p.x = x2; p.z = z2;
-
-    // Rotate Z
-    float x3 = p.x * cos(angleZ) - p.y * sin(angleZ);
-    float y3 = p.x * sin(angleZ) + p.y * cos(angleZ);
-    p.x = x3; p.y = y3;
+// Scale, rotate about X, Y and Z, then translate, composed into one matrix (the stack applies
+// the last operation first) and applied to every vertex in one pass
+Mat4 modelMatrix(float rx, float ry, float rz, float s) {
+    TransformStack3D t;
+    t.translate(tx, ty, tz);
+    t.rotateZ(rz);
+    t.rotateY(ry);
+    t.rotateX(rx);
+    t.scale(s, s, s);
+    return t.matrix();
+}
 
-    // Translate
-    p.x += tx; p.y += ty; p.z += tz;
+void applyTransform() {
+    transformVertices(modelMatrix(angleX, angleY, angleZ, scale), cube, transformed);
 }
 
 // ==== Draw Wireframe Cube ====
 
+void vertex(int i) {
+    glVertex3f(transformed.x[i], transformed.y[i], transformed.z[i]);
+}
+
 void drawCube() {
     glBegin(GL_LINE_LOOP); // back face
-    for (int i = 0; i < 4; ++i) {
-        Point3D p = cube[i];
-        applyTransform(p);
-        glVertex3f(p.x, p.y, p.z);
-    }
+    for (int i = 0; i < 4; ++i) vertex(i);
     glEnd();
 
     glBegin(GL_LINE_LOOP); // front face
-    for (int i = 4; i < 8; ++i) {
-        Point3D p = cube[i];
-        applyTransform(p);
-        glVertex3f(p.x, p.y, p.z);
-    }
+    for (int i = 4; i < 8; ++i) vertex(i);
     glEnd();
 
     // Connect corresponding vertices
+    glBegin(GL_LINES);
     for (int i = 0; i < 4; ++i) {
-        glBegin(GL_LINES);
-        Point3D p1 = cube[i], p2 = cube[i + 4];
-        applyTransform(p1); applyTransform(p2);
-        glVertex3f(p1.x, p1.y, p1.z);
-        glVertex3f(p2.x, p2.y, p2.z);
-        glEnd();
+        vertex(i);
+        vertex(i + 4);
     }
+    glEnd();
+}
+
+// ==== Offline Rendering ====
+
+// Same camera as display(); the parallel view is a true orthographic projection here
+Mat4 viewProjection(bool perspective, float aspect) {
+    if (perspective)
+        return Mat4::perspective(60, aspect, 1.0f, 100.0f) * Mat4::lookAt(4, 4, 4, 0, 0, 0, 0, 1, 0);
+    return Mat4::orthographic(-3 * aspect, 3 * aspect, -3, 3, 1.0f, 100.0f) * Mat4::translation(-1.5f, 0.0f, -6.0f);
+}
+
+// Function to render one offline frame: the schedule's angle spins the cube about Y
+void renderOfflineFrame(const FrameParams& params, Framebuffer& fb) {
+    thread_local VertexArray3 clip;
+    Mat4 m = viewProjection(params.perspective, (float)fb.width / fb.height) *
+             modelMatrix(angleX, degreesToRadians(params.angle), angleZ, params.scale);
+    clip.resize(cube.size());
+    transformVertices(m, cube, clip);
+
+    // transformVertices is affine, so the perspective w is computed here
+    int sx[8], sy[8];
+    bool visible[8];
+    for (int i = 0; i < 8; i++) {
+        float w = m.m[3][0] * cube.x[i] + m.m[3][1] * cube.y[i] + m.m[3][2] * cube.z[i] + m.m[3][3];
+        visible[i] = w > 1e-6f;
+        if (!visible[i]) continue;
+        sx[i] = (int)lround((clip.x[i] / w * 0.5f + 0.5f) * fb.width);
+        sy[i] = (int)lround((clip.y[i] / w * 0.5f + 0.5f) * fb.height);
+    }
+
+    static const int edges[12][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6},
+                                     {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+    fb.clear(0.0f, 0.0f, 0.0f);
+    fb.setColor(1.0f, 1.0f, 1.0f);
+    for (auto& e : edges)
+        if (visible[e[0]] && visible[e[1]]) bresenhamLine(fb, sx[e[0]], sy[e[0]], sx[e[1]], sy[e[1]]);
 }
 
 // ==== Display Function ====
@@ -91,6 +116,7 @@ void display() {
         glTranslatef(-1.5f, 0.0f, -6.0f); // Parallel projection simulation
 
     glColor3f(1.0, 1.0, 1.0);
+    applyTransform();
     drawCube();
 
     glutSwapBuffers();
@@ -126,6 +152,17 @@ void init() {
 }
 
 int main(int argc, char** argv) {
+    // Headless animation: "--offline" plus the options in OfflineRenderer.h
+    if (offlineRequested(argc, argv)) {
+        OfflineOptions options;
+        string error;
+        if (!parseOfflineOptions(argc, argv, options, error)) {
+            cerr << error << "\n";
+            return 1;
+        }
+        return renderOffline(options, renderOfflineFrame);
+    }
+
     cout << "Controls:\n"
          << "Rotate: [W/S] X, [A/D] Y, [Q/E] Z\n"
          << "Scale: [+ / -]\n"
@@ -3,9 +3,15 @@ algorithm and area subdivision algorithm for visible surface determination. Illu
 shading models, RGB color model and Basics of Computer Animation. */
 
 #include <GL/glut.h>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 #include <iostream>
+#include "FramebufferGL.h"
+#include "OfflineRenderer.h"
+#include "SoftwareRasterizer.h"
 using namespace std;
 
 // ==============================
@@ -14,6 +20,8 @@ using namespace std;
 float angle = 0.0;  // Animation rotation angle
 bool useZBuffer = true;
 bool usePhongShading = true;
+bool useSoftware = false;  // render on the CPU with SoftwareRasterizer
+VisibilityEngine engine = ENGINE_ZBUFFER;
 
 // ==============================
 // Light and Material Properties
@@ -66,10 +74,143 @@ void drawLitCube() {
     glPopMatrix();
 }
 
+// ==============================
+// Software Rasterizer
+// ==============================
+const int kWidth = 700, kHeight = 700;
+Framebuffer framebuffer(kWidth, kHeight);
+ThreadPool rasterPool;
+SoftwareRasterizer rasterizer(&rasterPool);
+RasterMesh torus;   // object space
+RasterMesh scene;   // world space: rotated torus plus the quads, shaded per frame
+RasterStats frameStats;
+
+// Function to build a torus around the z axis (outward faces counter-clockwise)
+void createTorus(RasterMesh& mesh, float major, float minor, int rings, int sides) {
+    mesh = RasterMesh();
+    for (int i = 0; i < rings; i++) {
+        float u = 2 * M_PI * i / rings;
+        for (int j = 0; j < sides; j++) {
+            float v = 2 * M_PI * j / sides;
+            float r = major + minor * cos(v);
+            mesh.positions.push_back(r * cos(u), r * sin(u), minor * sin(v));
+        }
+    }
+    for (int i = 0; i < rings; i++) {
+        for (int j = 0; j < sides; j++) {
+            uint32_t a = i * sides + j, b = ((i + 1) % rings) * sides + j;
+            uint32_t c = ((i + 1) % rings) * sides + (j + 1) % sides, d = i * sides + (j + 1) % sides;
+            mesh.indices.insert(mesh.indices.end(), {a, b, c, a, c, d});
+        }
+    }
+    mesh.colors.assign(mesh.triangleCount(), 0);
+}
+
+// Function to shade a triangle with the fixed light (ambient + Lambert diffuse)
+uint32_t shadeTriangle(const VertexArray3& p, uint32_t i0, uint32_t i1, uint32_t i2, const GLfloat* color) {
+    float ux = p.x[i1] - p.x[i0], uy = p.y[i1] - p.y[i0], uz = p.z[i1] - p.z[i0];
+    float vx = p.x[i2] - p.x[i0], vy = p.y[i2] - p.y[i0], vz = p.z[i2] - p.z[i0];
+    float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+    float lx = light_pos[0] - p.x[i0], ly = light_pos[1] - p.y[i0], lz = light_pos[2] - p.z[i0];
+    float len = sqrt((nx * nx + ny * ny + nz * nz) * (lx * lx + ly * ly + lz * lz));
+    float lambert = len > 0 ? max(0.0f, (nx * lx + ny * ly + nz * lz) / len) : 0;
+    float k = ambient[0] + diffuse[0] * lambert;
+    return Framebuffer::pack(color[0] * k, color[1] * k, color[2] * k);
+}
+
+// Function to build the world-space scene for one animation step; only reads shared state,
+// so offline frames can build their scenes concurrently
+void buildScene(float degrees, float size, RasterMesh& out) {
+    TransformStack3D model;
+    // glRotatef(degrees, 1, 1, 0): bring the (1, 1, 0) axis onto x, rotate, and back
+    model.rotateZ(degreesToRadians(45.0f));
+    model.rotateX(degreesToRadians(degrees));
+    model.rotateZ(degreesToRadians(-45.0f));
+    model.scale(size, size, size);
+    out.positions.resize(torus.positions.size());
+    transformVertices(model.matrix(), torus.positions, out.positions);
+    out.indices = torus.indices;
+    out.colors.resize(torus.triangleCount());
+
+    const GLfloat torusColor[3] = {0.9f, 0.6f, 0.2f};
+    for (size_t t = 0; t < torus.triangleCount(); t++)
+        out.colors[t] = shadeTriangle(out.positions, out.indices[t * 3], out.indices[t * 3 + 1],
+                                      out.indices[t * 3 + 2], torusColor);
+
+    // The quads intersect the torus, so only per-pixel depth gets them right
+    for (const auto& quad : quads) {
+        uint32_t base = (uint32_t)out.positions.size();
+        for (int i = 0; i < 4; i++)
+            out.positions.push_back(quad.vertices[i][0], quad.vertices[i][1], quad.vertices[i][2]);
+        out.indices.insert(out.indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+        uint32_t c = Framebuffer::pack(quad.color[0], quad.color[1], quad.color[2]);
+        out.colors.insert(out.colors.end(), {c, c});
+    }
+}
+
+// Camera of the GL view; the parallel projection covers about the same area at the origin
+Mat4 viewProjection(bool perspective, float aspect) {
+    Mat4 projection = perspective ? Mat4::perspective(60.0f, aspect, 1.0f, 10.0f)
+                                  : Mat4::orthographic(-1.8f * aspect, 1.8f * aspect, -1.8f, 1.8f, 1.0f, 10.0f);
+    return projection * Mat4::lookAt(1.5f, 1.5f, 2.5f, 0, 0, 0, 0, 1, 0);
+}
+
+// Function to render the scene into the framebuffer with the selected engine
+void renderSoftware() {
+    buildScene(angle, 1.0f, scene);
+    framebuffer.clear(0.1f, 0.1f, 0.1f);
+    frameStats = rasterizer.draw(framebuffer, scene, viewProjection(true, (float)kWidth / kHeight), engine);
+}
+
+// Function to render one offline frame; runs on pool threads, each with its own scratch
+void renderOfflineFrame(const FrameParams& params, Framebuffer& fb) {
+    thread_local RasterMesh frameScene;
+    thread_local SoftwareRasterizer frameRasterizer;
+    buildScene(params.angle, params.scale, frameScene);
+    fb.clear(0.1f, 0.1f, 0.1f);
+    frameRasterizer.draw(fb, frameScene, viewProjection(params.perspective, (float)fb.width / fb.height), engine);
+}
+
+// Function to print one row of the statistics table
+void printStats(const char* name, const RasterStats& s, int frames) {
+    printf("%-28s %10.0f %9.2f %11.2f %12zu %10zu\n", name, s.trianglesPerSecond(), s.overdraw(),
+           s.milliseconds / frames, s.blocksRejected / frames, s.fragments / frames);
+}
+
+// Function to render the animation headless with every engine and compare them
+void benchmarkEngines(int frames) {
+    printf("%zu triangles, %dx%d, %zu threads, %d frames per engine\n", torus.triangleCount() + 6, kWidth,
+           kHeight, rasterPool.size(), frames);
+    printf("%-28s %10s %9s %11s %12s %10s\n", "engine", "tris/sec", "overdraw", "ms/frame", "hiZ rejects",
+           "fragments");
+    float start = angle;
+    for (VisibilityEngine e : {ENGINE_ZBUFFER, ENGINE_PAINTER, ENGINE_WARNOCK}) {
+        engine = e;
+        RasterStats total;
+        angle = start;
+        for (int f = 0; f < frames; f++, angle += 1.0f) {
+            renderSoftware();
+            total += frameStats;
+        }
+        // Overdraw and hierarchical-Z are per frame; the sums above keep their ratios
+        printStats(engineName(e), total, frames);
+    }
+    engine = ENGINE_ZBUFFER;
+    angle = start;
+}
+
 // ==============================
 // Display Function
 // ==============================
 void display() {
+    if (useSoftware) {
+        renderSoftware();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GLUTTarget().present(framebuffer);
+        glutSwapBuffers();
+        return;
+    }
+
     if (useZBuffer) glEnable(GL_DEPTH_TEST);
     else glDisable(GL_DEPTH_TEST);
 
@@ -106,6 +247,11 @@ void keyboard(unsigned char key, int, int) {
     switch (key) {
         case 'z': useZBuffer = !useZBuffer; break;
         case 'p': usePhongShading = !usePhongShading; break;
+        case 's': useSoftware = !useSoftware; break;
+        case 'e':
+            engine = (VisibilityEngine)((engine + 1) % 3);
+            cout << "Software engine: " << engineName(engine) << "\n";
+            break;
         case 27: exit(0);
     }
     glutPostRedisplay();
@@ -116,6 +262,7 @@ void keyboard(unsigned char key, int, int) {
 // ==============================
 void init() {
     createQuads();
+    createTorus(torus, 0.5f, 0.2f, 96, 48);
     glEnable(GL_LIGHT0);
     glLightfv(GL_LIGHT0, GL_POSITION, light_pos);
     glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
@@ -142,9 +289,45 @@ void init() {
 // Main Function
 // ==============================
 int main(int argc, char** argv) {
+    // Headless: "--offline ..." renders an animation (see OfflineRenderer.h), "--raster
+    // [frames]" compares the software engines, "-o <file>" saves a frame
+    if (offlineRequested(argc, argv)) {
+        OfflineOptions options;
+        string error;
+        if (!parseOfflineOptions(argc, argv, options, error)) {
+            cerr << error << "\n";
+            return 1;
+        }
+        createQuads();
+        createTorus(torus, 0.5f, 0.2f, 96, 48);
+        return renderOffline(options, renderOfflineFrame);
+    }
+    string output = headlessOutput(argc, argv);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--raster") == 0) {
+            createQuads();
+            createTorus(torus, 0.5f, 0.2f, 96, 48);
+            benchmarkEngines(i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[i + 1]) : 60);
+            if (!output.empty()) {
+                renderSoftware();
+                return makeFileTarget(output)->present(framebuffer) ? 0 : 1;
+            }
+            return 0;
+        }
+    }
+    if (!output.empty()) {
+        createQuads();
+        createTorus(torus, 0.5f, 0.2f, 96, 48);
+        angle = 30.0f;
+        renderSoftware();
+        return makeFileTarget(output)->present(framebuffer) ? 0 : 1;
+    }
+
     cout << "Controls:\n"
          << "[Z] Toggle Z-buffer / Painter's algorithm\n"
          << "[P] Toggle Phong shading\n"
+         << "[S] Toggle software rasterizer\n"
+         << "[E] Cycle software engine (Z-buffer, painter's, Warnock)\n"
          << "[ESC] Exit\n";
 
     glutInit(&argc, argv);
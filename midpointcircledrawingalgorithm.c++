@@ -3,57 +3,34 @@
 #include <GL/glut.h>
 #include <iostream>
 #include <cmath>
+#include "Framebuffer.h"
+#include "FramebufferGL.h"
+#include "RasterPrimitives.h"
 using namespace std;
 
 // Circle center and radius
 int xc, yc, r;
 
-void plot(int x, int y) {
-    glBegin(GL_POINTS);
-    glVertex2i(xc + x, yc + y);
-    glVertex2i(xc - x, yc + y);
-    glVertex2i(xc + x, yc - y);
-    glVertex2i(xc - x, yc - y);
-    glVertex2i(xc + y, yc + x);
-    glVertex2i(xc - y, yc + x);
-    glVertex2i(xc + y, yc - x);
-    glVertex2i(xc - y, yc - x);
-    glEnd();
-}
-
-void midPointCircle(int xc, int yc, int r) {
-    int x = 0;
-    int y = r;
-    int p = 1 - r;  // Mid-point decision parameter
-
-    plot(x, y); // Plot the initial points
+// The circle is rasterized into memory and uploaded once per frame
+Framebuffer framebuffer(500, 500);
 
-    while (x < y) {
-        x++;
+void renderScene() {
+    framebuffer.clear(1, 1, 1);     // White background
+    framebuffer.setColor(0, 0, 0);  // Black color for drawing
 
-        if (p < 0) {
-            p += 2*x + 1;
-        } else {
-            y--;
-            p += 2*(x - y) + 1;
-        }
-
-        plot(x, y);
-    }
+    // Mid-point Circle Drawing
+    midpointCircle(framebuffer, xc, yc, r);  // RasterPrimitives.h
 }
 
 void display() {
     glClear(GL_COLOR_BUFFER_BIT);
-
-    // Mid-point Circle Drawing
-    midPointCircle(xc, yc, r);
-
+    renderScene();
+    GLUTTarget().present(framebuffer);
     glFlush();
 }
 
 void init() {
     glClearColor(1, 1, 1, 1);  // White background
-    glColor3f(0, 0, 0);        // Black color for drawing
     gluOrtho2D(0, 500, 0, 500); // 2D coordinate system
 }
 
@@ -63,6 +40,13 @@ int main(int argc, char** argv) {
     cout << "Enter the radius of the circle: ";
     cin >> r;
 
+    // "-o circle.png" renders without a window
+    string output = headlessOutput(argc, argv);
+    if (!output.empty()) {
+        renderScene();
+        return makeFileTarget(output)->present(framebuffer) ? 0 : 1;
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(500, 500);